@@ -0,0 +1,366 @@
+/**
+ * Microbenchmarks of the SZ3 building blocks.
+ * Every kernel runs in isolation on a synthetic Gaussian random field (see Synthetic.hpp), for float and double,
+ * N = 1..4 and several error bounds (relative to the value range).
+ * One JSON object per line is written for every measurement.
+ */
+
+#include "SZ3/quantizer/IntegerQuantizer.hpp"
+#include "SZ3/quantizer/QoIIntegerQuantizer.hpp"
+#include "SZ3/predictor/LorenzoPredictor.hpp"
+#include "SZ3/predictor/RegressionPredictor.hpp"
+#include "SZ3/encoder/HuffmanEncoder.hpp"
+#include "SZ3/encoder/QoIEncoder.hpp"
+#include "SZ3/lossless/Lossless_zstd.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/qoi/QoIInfo.hpp"
+#include "SZ3/utils/Interpolators.hpp"
+#include "SZ3/utils/Iterator.hpp"
+#include "SZ3/utils/Synthetic.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BenchOptions {
+    size_t elements = 1 << 22;  // per field, rounded to the nearest N-D shape
+    int reps = 3;               // the fastest repetition is reported
+    std::vector<double> ebs = {1e-2, 1e-4, 1e-6};
+    std::string filter;         // only run the kernels whose name contains this
+    FILE *out = stdout;
+};
+
+BenchOptions opt;
+
+template<class T>
+const char *type_str() { return std::is_same<T, float>::value ? "float" : "double"; }
+
+/**
+ * Time a kernel and report it
+ * @param setup untimed preparation before every repetition
+ * @param run the kernel
+ * @param elements number of elements processed by one run
+ * @param bytes number of input bytes processed by one run
+ */
+template<class T>
+void measure(const char *kernel, uint N, double eb, size_t elements, size_t bytes,
+             const std::function<void()> &setup, const std::function<void()> &run) {
+    if (!opt.filter.empty() && std::string(kernel).find(opt.filter) == std::string::npos) {
+        return;
+    }
+    double best = 0;
+    for (int r = 0; r < opt.reps; r++) {
+        setup();
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    fprintf(opt.out, "{\"kernel\": \"%s\", \"type\": \"%s\", \"N\": %u, \"eb\": %g, \"elements\": %zu, "
+                     "\"bytes\": %zu, \"seconds\": %.9f, \"GBps\": %.4f, \"ns_per_element\": %.4f}\n",
+            kernel, type_str<T>(), N, eb, elements, bytes, best, best > 0 ? bytes / best * 1e-9 : 0,
+            elements ? best * 1e9 / elements : 0);
+    fflush(opt.out);
+}
+
+// defeat dead code elimination of results that are only summed
+template<class T>
+void consume(T v) {
+    static volatile T sink = 0;
+    sink = sink + v;
+}
+
+template<uint N>
+std::array<size_t, N> bench_dims(size_t elements) {
+    std::array<size_t, N> dims;
+    dims.fill(std::max<size_t>(2, std::round(std::pow((double) elements, 1.0 / N))));
+    return dims;
+}
+
+template<class T, uint N>
+void bench(double rel_eb) {
+    auto dims = bench_dims<N>(opt.elements);
+    size_t num = 1;
+    for (auto d: dims) num *= d;
+    std::vector<T> ori(num);
+    SZ::synthetic_grf(ori.data(), std::vector<size_t>(dims.begin(), dims.end()));
+    size_t bytes = num * sizeof(T);
+    auto minmax = std::minmax_element(ori.begin(), ori.end());
+    double eb = rel_eb * (*minmax.second - *minmax.first);
+    std::vector<T> data(num);
+    auto reset = [&]() { std::copy(ori.begin(), ori.end(), data.begin()); };
+
+    // quantizers, predicted by the previous element
+    std::vector<int> quant_inds(num);
+    SZ::LinearQuantizer<T> quantizer(eb);
+    measure<T>("linear_quantizer", N, rel_eb, num, bytes, [&]() { reset(); quantizer.clear(); }, [&]() {
+        T pred = 0;
+        for (size_t i = 0; i < num; i++) {
+            T cur = data[i];
+            quant_inds[i] = quantizer.quantize_and_overwrite(data[i], pred);
+            pred = cur;
+        }
+    });
+    std::vector<T> pred_values(num);
+    pred_values[0] = 0;
+    std::copy(ori.begin(), ori.end() - 1, pred_values.begin() + 1);
+    measure<T>("linear_quantizer_recover", N, rel_eb, num, bytes, []() {}, [&]() {
+        for (size_t i = 0; i < num; i++) {
+            data[i] = quantizer.recover(pred_values[i], quant_inds[i]);
+        }
+    });
+
+    SZ::VariableEBLinearQuantizer<T, T> var_quantizer;
+    measure<T>("variable_eb_quantizer", N, rel_eb, num, bytes, [&]() { reset(); var_quantizer.clear(); }, [&]() {
+        for (size_t i = 0; i < num; i++) {
+            // vary the bound like a QoI would
+            quant_inds[i] = var_quantizer.quantize_and_overwrite(data[i], pred_values[i], eb * (1 + (i & 7)));
+        }
+    });
+
+    std::vector<T> ebs(num);
+    SZ::EBLogQuantizer<T> eb_quantizer(eb * 1e-3, 2, 32);
+    measure<T>("eb_log_quantizer", N, rel_eb, num, bytes, [&]() {
+        for (size_t i = 0; i < num; i++) ebs[i] = eb * (1 + std::fabs(ori[i]));
+    }, [&]() {
+        for (size_t i = 0; i < num; i++) {
+            quant_inds[i] = eb_quantizer.quantize_and_overwrite(ebs[i]);
+        }
+    });
+
+    // predictors, traversed block by block as in SZGeneralFrontend
+    auto block_size = N == 1 ? 128 : (N == 2 ? 16 : 6);
+    auto block_range = std::make_shared<SZ::multi_dimensional_range<T, N>>(
+            data.data(), std::begin(dims), std::end(dims), block_size, 0);
+    auto element_range = std::make_shared<SZ::multi_dimensional_range<T, N>>(
+            data.data(), std::begin(dims), std::end(dims), 1, 0);
+    auto predict_all = [&](auto &predictor) {
+        T sum = 0;
+        for (auto block = block_range->begin(); block != block_range->end(); ++block) {
+            element_range->update_block_range(block, block_size);
+            predictor.precompress_block(element_range);
+            predictor.precompress_block_commit();
+            for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                sum += predictor.predict(element);
+            }
+        }
+        consume(sum);
+    };
+    SZ::LorenzoPredictor<T, N, 1> lorenzo(eb);
+    measure<T>("lorenzo", N, rel_eb, num, bytes, reset, [&]() { predict_all(lorenzo); });
+    SZ::RegressionPredictor<T, N> regression(block_size, eb);
+    measure<T>("regression", N, rel_eb, num, bytes, reset, [&]() {
+        regression.clear();
+        predict_all(regression);
+    });
+
+    // interpolation along the slowest dimension, which has the largest stride
+    size_t stride = num / dims[0];
+    size_t interp_num = num - 6 * stride;
+    measure<T>("interp_linear", N, rel_eb, interp_num, interp_num * sizeof(T), reset, [&]() {
+        T *d = data.data();
+        for (size_t i = 3 * stride; i < num - 3 * stride; i++) {
+            d[i] = SZ::interp_linear(d[i - stride], d[i + stride]);
+        }
+    });
+    measure<T>("interp_cubic", N, rel_eb, interp_num, interp_num * sizeof(T), reset, [&]() {
+        T *d = data.data();
+        for (size_t i = 3 * stride; i < num - 3 * stride; i++) {
+            d[i] = SZ::interp_cubic(d[i - 3 * stride], d[i - stride], d[i + stride], d[i + 3 * stride]);
+        }
+    });
+
+    // encoders on the Lorenzo quantization indices
+    reset();
+    quantizer.clear();
+    {
+        size_t i = 0;
+        auto full_range = std::make_shared<SZ::multi_dimensional_range<T, N>>(
+                data.data(), std::begin(dims), std::end(dims), 1, 0);
+        // one block over the whole field: its left boundary is the data's, and the stencil offsets are set even
+        // when the "lorenzo" measurement is filtered out
+        full_range->update_block_range(full_range->begin(), dims);
+        lorenzo.precompress_block(full_range);
+        for (auto element = full_range->begin(); element != full_range->end(); ++element) {
+            quant_inds[i++] = quantizer.quantize_and_overwrite(*element, lorenzo.predict(element));
+        }
+    }
+    size_t inds_bytes = num * sizeof(int);
+    std::vector<SZ::uchar> encoded(inds_bytes * 2 + 1024 * 1024);
+    size_t encoded_size = 0;
+    auto huffman_encode = [&]() {
+        SZ::HuffmanEncoder<int> encoder;
+        encoder.preprocess_encode(quant_inds, 4 * quantizer.get_radius());
+        SZ::uchar *pos = encoded.data();
+        encoder.save(pos);
+        encoder.encode(quant_inds, pos);
+        encoder.postprocess_encode();
+        encoded_size = pos - encoded.data();
+    };
+    // the decoders and zstd take the encoded data, also when the encoders are filtered out
+    huffman_encode();
+    measure<T>("huffman_encode", N, rel_eb, num, inds_bytes, []() {}, huffman_encode);
+    measure<T>("huffman_decode", N, rel_eb, num, inds_bytes, []() {}, [&]() {
+        SZ::HuffmanEncoder<int> encoder;
+        const SZ::uchar *pos = encoded.data();
+        size_t remaining = encoded_size;
+        encoder.load(pos, remaining);
+        consume(encoder.decode(pos, num).back());
+        encoder.postprocess_decode();
+    });
+
+    std::vector<int> qoi_inds(2 * num);
+    for (size_t i = 0; i < num; i++) {
+        qoi_inds[i] = eb_quantizer.quantize(eb * (1 + std::fabs(ori[i])));
+        qoi_inds[num + i] = quant_inds[i];
+    }
+    std::vector<SZ::uchar> qoi_encoded(2 * encoded.size());
+    size_t qoi_encoded_size = 0;
+    auto qoi_encode = [&]() {
+        SZ::QoIEncoder<int> encoder;
+        encoder.preprocess_encode(qoi_inds, 0);
+        SZ::uchar *pos = qoi_encoded.data();
+        encoder.save(pos);
+        encoder.encode(qoi_inds, pos);
+        encoder.postprocess_encode();
+        qoi_encoded_size = pos - qoi_encoded.data();
+    };
+    qoi_encode();
+    measure<T>("qoi_encode", N, rel_eb, 2 * num, 2 * inds_bytes, []() {}, qoi_encode);
+    measure<T>("qoi_decode", N, rel_eb, 2 * num, 2 * inds_bytes, []() {}, [&]() {
+        SZ::QoIEncoder<int> encoder;
+        const SZ::uchar *pos = qoi_encoded.data();
+        size_t remaining = qoi_encoded_size;
+        encoder.load(pos, remaining);
+        consume(encoder.decode(pos, num).back());
+        encoder.postprocess_decode();
+    });
+
+    SZ::Lossless_zstd zstd;
+    size_t compressed_size = 0;
+    SZ::uchar *compressed = zstd.compress(encoded.data(), encoded_size, compressed_size);
+    measure<T>("zstd_compress", N, rel_eb, encoded_size, encoded_size, [&]() { delete[] compressed; }, [&]() {
+        compressed = zstd.compress(encoded.data(), encoded_size, compressed_size);
+    });
+    measure<T>("zstd_decompress", N, rel_eb, encoded_size, encoded_size, []() {}, [&]() {
+        size_t size = compressed_size;
+        delete[] zstd.decompress(compressed, size);
+    });
+    delete[] compressed;
+
+    // QoIs, with the per element calls of SZQoIFrontend
+    std::vector<T> isovalues = {(T) -0.5, (T) 0, (T) 0.5};
+    std::vector<size_t> dims_vec(dims.begin(), dims.end());
+    std::vector<std::pair<const char *, std::shared_ptr<SZ::concepts::QoIInterface<T, N>>>> qois = {
+            {"qoi_x_square",                std::make_shared<SZ::QoI_X_Square<T, N>>(eb, eb)},
+            {"qoi_log_x",                   std::make_shared<SZ::QoI_Log_X<T, N>>(rel_eb, eb)},
+            {"qoi_regional_average",        std::make_shared<SZ::QoI_RegionalAverage<T, N>>(eb, eb)},
+            {"qoi_regional_average_square", std::make_shared<SZ::QoI_RegionalAverageOfSquare<T, N>>(eb, eb)},
+            {"qoi_isoline",                 std::make_shared<SZ::QoI_Isoline<T, N>>(dims_vec, isovalues, eb)},
+    };
+    std::vector<std::shared_ptr<SZ::concepts::QoIInterface<T, N>>> multi = {qois[0].second, qois[1].second};
+    qois.emplace_back("qoi_multi", std::make_shared<SZ::QoI_MultiQoIs<T, N>>(multi));
+    for (auto &q: qois) {
+        auto &qoi = q.second;
+        qoi->init();
+        measure<T>(q.first, N, rel_eb, num, bytes, reset, [&]() {
+            size_t fails = 0;
+            for (auto block = block_range->begin(); block != block_range->end(); ++block) {
+                element_range->update_block_range(block, block_size);
+                qoi->precompress_block(element_range);
+                for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                    T ori_data = *element;
+                    T qoi_eb = qoi->interpret_eb(element);
+                    T dec_data = ori_data + (T) 0.5 * qoi_eb;
+                    fails += !qoi->check_compliance(ori_data, dec_data);
+                    qoi->update_tolerance(ori_data, dec_data);
+                }
+                qoi->postcompress_block();
+            }
+            consume(fails);
+        });
+    }
+}
+
+template<class T>
+void bench_type() {
+    for (auto eb: opt.ebs) {
+        bench<T, 1>(eb);
+        bench<T, 2>(eb);
+        bench<T, 3>(eb);
+        bench<T, 4>(eb);
+    }
+}
+
+void usage() {
+    printf("Usage: sz_bench <options>\n");
+    printf("Options:\n");
+    printf("	-n <elements> : number of elements per field (default 4194304)\n");
+    printf("	-r <reps> : repetitions of each kernel, the fastest is reported (default 3)\n");
+    printf("	-e <eb> ... : error bounds relative to the value range (default 1e-2 1e-4 1e-6)\n");
+    printf("	-k <kernel> : only run the kernels whose name contains <kernel>\n");
+    printf("	-t <f|d> : only run float or double\n");
+    printf("	-o <file> : write the results to <file>, one JSON object per line (default stdout)\n");
+    printf("* examples: \n");
+    printf("	sz_bench -o bench.jsonl\n");
+    printf("	sz_bench -k quantizer -t f -e 1e-3\n");
+    exit(0);
+}
+
+int main(int argc, char *argv[]) {
+    char type = 0;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-' || argv[i][2] || i + 1 >= argc) {
+            usage();
+        }
+        switch (argv[i][1]) {
+            case 'n':
+                opt.elements = atol(argv[++i]);
+                break;
+            case 'r':
+                opt.reps = atoi(argv[++i]);
+                break;
+            case 'e':
+                opt.ebs.clear();
+                while (i + 1 < argc && argv[i + 1][0] != '-') {
+                    opt.ebs.push_back(atof(argv[++i]));
+                }
+                break;
+            case 'k':
+                opt.filter = argv[++i];
+                break;
+            case 't':
+                type = argv[++i][0];
+                break;
+            case 'o':
+                opt.out = fopen(argv[++i], "w");
+                if (opt.out == nullptr) {
+                    printf("Error, cannot open %s\n", argv[i]);
+                    exit(0);
+                }
+                break;
+            default:
+                usage();
+        }
+    }
+    if (opt.ebs.empty() || opt.reps < 1) {
+        usage();
+    }
+    if (type != 'd') {
+        bench_type<float>();
+    }
+    if (type != 'f') {
+        bench_type<double>();
+    }
+    if (opt.out != stdout) {
+        fclose(opt.out);
+    }
+    return 0;
+}
@@ -0,0 +1,431 @@
+/**
+ * Performance regression harness.
+ * Runs a fixed matrix of synthetic datasets x algorithms x QoI modes x thread counts, records compression and
+ * decompression throughput, compression ratio and peak RSS to JSON, and optionally compares them with a baseline.
+ * Every case runs in its own child process, so a case that aborts does not stop the others and the peak RSS
+ * belongs to that case only. The exit code is 1 if any case regressed against the baseline, 0 otherwise; a baseline
+ * case without its expected status counts as a regression, such a baseline has to be regenerated.
+ * ALGO_INTERP has no regional averages (QoI 3), the expected status of that combination is "rejected".
+ */
+
+#include "SZ3/api/sz.hpp"
+#include "SZ3/utils/Synthetic.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+struct RegressionOptions {
+    std::vector<std::string> datasets = {"grf", "cloud", "smooth"};
+    std::vector<size_t> dims = {64, 64, 64};
+    std::vector<int> algos = {SZ::ALGO_INTERP, SZ::ALGO_LORENZO_REG, SZ::ALGO_INTERP_LORENZO};
+    std::vector<int> qois = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<int> threads = {1, 4};
+    double relEB = 1e-3;
+    double qoiEB = 1e-3;
+    int reps = 3;
+    int timeout = 120;              // seconds per case, a hung case is killed and reported as timeout
+    double threshold = 0.10;        // allowed relative throughput drop, widened by the measured noise
+    double ratioThreshold = 0.01;   // allowed relative compression ratio drop
+    double rssThreshold = 0.25;     // allowed relative peak RSS growth
+    const char *outPath = nullptr;
+    const char *baselinePath = nullptr;
+};
+
+RegressionOptions opt;
+
+struct CaseResult {
+    bool ok = false;
+    double compressBest = 0, compressMedian = 0;    // seconds
+    double decompressBest = 0, decompressMedian = 0;
+    double ratio = 0;
+    double maxErr = 0;
+    double absEB = 0;
+};
+
+using Record = std::map<std::string, std::string>;
+
+std::string case_key(const std::string &dataset, int algo, int qoi, int threads) {
+    return dataset + "/" + SZ::ALGO_STR[algo] + "/qoi" + std::to_string(qoi) + "/t" + std::to_string(threads);
+}
+
+// status of a case that works as intended, "rejected" for the combinations the library refuses
+std::string expected_status(int algo, int qoi) {
+    return algo == SZ::ALGO_INTERP && qoi == 3 ? "rejected" : "ok";
+}
+
+// the QoI tolerances that SZ_compress_Interp_lorenzo derives by itself, the other algorithms take them from conf
+void set_qoi(SZ::Config &conf, int qoi, double min, double max) {
+    conf.qoi = qoi;
+    conf.qoiEB = opt.qoiEB;
+    conf.qoiIsoNum = 1;
+    if (qoi == 0 || conf.cmprAlgo == SZ::ALGO_INTERP_LORENZO) {
+        return;
+    }
+    double max_abs = std::max(std::fabs(min), std::fabs(max));
+    if (qoi == 3) {
+        conf.qoiEB *= max;
+    }
+    conf.isovalues.clear();
+    if (qoi >= 4) {
+        conf.isovalues.push_back(min + (max - min) / 2);
+    }
+    double eb_x2 = opt.qoiEB * max_abs * max_abs, eb_logx = opt.qoiEB * 10;
+    if (qoi == 5) conf.qoiEBs = {eb_x2, eb_logx};
+    if (qoi == 6) conf.qoiEBs = {eb_x2, 0};
+    if (qoi == 7) conf.qoiEBs = {eb_logx, 0};
+    if (qoi == 8) conf.qoiEBs = {eb_x2, eb_logx, 0};
+    conf.qoiEBLogBase = 2;
+    conf.qoiEBBase = (qoi != 4 && qoi != 7) ? (max - min) * opt.qoiEB / 1030 : std::numeric_limits<float>::epsilon();
+}
+
+// compress and decompress one case, run in the child process
+CaseResult run_case(const std::string &dataset, int algo, int qoi, int threads) {
+    CaseResult res;
+    omp_set_num_threads(threads);
+    SZ::Config conf;
+    conf.setDims(opt.dims.begin(), opt.dims.end());
+    std::vector<float> ori(conf.num), data(conf.num);
+    SZ::synthetic_load("synthetic:" + dataset, ori.data(), opt.dims);
+    auto minmax = std::minmax_element(ori.begin(), ori.end());
+    conf.cmprAlgo = algo;
+    conf.errorBoundMode = SZ::EB_REL;
+    conf.relErrorBound = opt.relEB;
+    conf.openmp = threads > 1;
+    set_qoi(conf, qoi, *minmax.first, *minmax.second);
+
+    std::vector<double> cmp_times, dec_times;
+    for (int r = 0; r < opt.reps; r++) {
+        std::copy(ori.begin(), ori.end(), data.begin());
+        SZ::Config c = conf;
+        size_t cmpSize;
+        auto begin = std::chrono::steady_clock::now();
+        char *cmpData = SZ_compress<float>(c, data.data(), cmpSize);
+        cmp_times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+        SZ::Config d;
+        float *decData = nullptr;
+        begin = std::chrono::steady_clock::now();
+        SZ_decompress<float>(d, cmpData, cmpSize, decData);
+        dec_times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+        res.ratio = conf.num * sizeof(float) * 1.0 / cmpSize;
+        res.absEB = c.absErrorBound;
+        res.maxErr = 0;
+        for (size_t i = 0; i < conf.num; i++) {
+            res.maxErr = std::max(res.maxErr, (double) std::fabs(ori[i] - decData[i]));
+        }
+        delete[] cmpData;
+        delete[] decData;
+    }
+    std::sort(cmp_times.begin(), cmp_times.end());
+    std::sort(dec_times.begin(), dec_times.end());
+    res.compressBest = cmp_times.front();
+    res.compressMedian = cmp_times[cmp_times.size() / 2];
+    res.decompressBest = dec_times.front();
+    res.decompressMedian = dec_times[dec_times.size() / 2];
+    res.ok = true;
+    return res;
+}
+
+Record run_isolated(const std::string &dataset, int algo, int qoi, int threads) {
+    Record rec;
+    rec["key"] = case_key(dataset, algo, qoi, threads);
+    rec["dataset"] = dataset;
+    rec["algo"] = SZ::ALGO_STR[algo];
+    rec["qoi"] = std::to_string(qoi);
+    rec["threads"] = std::to_string(threads);
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        printf("Error, cannot create a pipe\n");
+        exit(1);
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // the compressors print progress, keep the report readable
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(fds[0]);
+        alarm(opt.timeout);
+        CaseResult res = run_case(dataset, algo, qoi, threads);
+        if (write(fds[1], &res, sizeof(res)) != sizeof(res)) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    CaseResult res;
+    bool received = read(fds[0], &res, sizeof(res)) == sizeof(res);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+
+    size_t bytes = 1;
+    for (auto d: opt.dims) bytes *= d;
+    bytes *= sizeof(float);
+    char buf[64];
+    auto num = [&](double v) {
+        snprintf(buf, sizeof(buf), "%.6g", v);
+        return std::string(buf);
+    };
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        rec["status"] = "timeout";
+        return rec;
+    }
+    if (!received && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        // SZ3 reports unsupported configurations and exits with 0
+        rec["status"] = "rejected";
+        return rec;
+    }
+    if (!received || !res.ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        rec["status"] = "failed";
+        return rec;
+    }
+    rec["status"] = res.maxErr <= res.absEB * (1 + 1e-6) ? "ok" : "error_bound_violated";
+    rec["compress_MBps"] = num(bytes / res.compressBest * 1e-6);
+    rec["compress_noise"] = num(res.compressMedian / res.compressBest - 1);
+    rec["decompress_MBps"] = num(bytes / res.decompressBest * 1e-6);
+    rec["decompress_noise"] = num(res.decompressMedian / res.decompressBest - 1);
+    rec["ratio"] = num(res.ratio);
+    rec["max_error"] = num(res.maxErr);
+    rec["peak_rss_KB"] = std::to_string(usage.ru_maxrss);
+    return rec;
+}
+
+void write_json(const char *path, const std::vector<Record> &records) {
+    FILE *f = fopen(path, "w");
+    if (f == nullptr) {
+        printf("Error, cannot open %s\n", path);
+        exit(1);
+    }
+    fprintf(f, "{\n  \"dims\": [");
+    for (size_t i = 0; i < opt.dims.size(); i++) {
+        fprintf(f, "%s%zu", i ? ", " : "", opt.dims[i]);
+    }
+    fprintf(f, "],\n  \"rel_eb\": %g,\n  \"cases\": [\n", opt.relEB);
+    for (size_t i = 0; i < records.size(); i++) {
+        fprintf(f, "    {");
+        bool first = true;
+        for (const auto &kv: records[i]) {
+            bool quoted = kv.first == "key" || kv.first == "dataset" || kv.first == "algo" || kv.first == "status";
+            fprintf(f, "%s\"%s\": %s%s%s", first ? "" : ", ", kv.first.c_str(), quoted ? "\"" : "",
+                    kv.second.c_str(), quoted ? "\"" : "");
+            first = false;
+        }
+        fprintf(f, "}%s\n", i + 1 < records.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+}
+
+// read the flat case objects written by write_json()
+std::map<std::string, Record> read_json(const char *path) {
+    size_t size;
+    auto text = SZ::readfile<char>(path, size);
+    std::string s(text.get(), size);
+    std::map<std::string, Record> cases;
+    size_t pos = s.find("\"cases\"");
+    while (pos != std::string::npos && (pos = s.find('{', pos)) != std::string::npos) {
+        size_t end = s.find('}', pos);
+        std::string obj = s.substr(pos + 1, end - pos - 1);
+        Record rec;
+        size_t p = 0;
+        while ((p = obj.find('"', p)) != std::string::npos) {
+            size_t q = obj.find('"', p + 1);
+            std::string key = obj.substr(p + 1, q - p - 1);
+            size_t v = obj.find_first_not_of(" :", q + 1);
+            size_t w = obj[v] == '"' ? obj.find('"', v + 1) + 1 : obj.find_first_of(",", v);
+            std::string value = obj.substr(v, (w == std::string::npos ? obj.size() : w) - v);
+            if (value.front() == '"') value = value.substr(1, value.size() - 2);
+            rec[key] = value;
+            p = w == std::string::npos ? obj.size() : w;
+        }
+        cases[rec["key"]] = rec;
+        pos = end;
+    }
+    return cases;
+}
+
+/**
+ * Compare one case with its baseline
+ * A throughput drop counts only if it exceeds both the threshold and three times the noise of either run,
+ * the noise being how much slower the median repetition was than the fastest.
+ * @return the regressions, empty if none
+ */
+std::vector<std::string> compare(const Record &cur, const Record &base, const std::string &expected) {
+    std::vector<std::string> msgs;
+    if (base.at("status") != expected) {
+        // a case that did not run as intended cannot be compared, the baseline has to be regenerated
+        msgs.push_back("baseline status " + base.at("status") + ", regenerate the baseline");
+        return msgs;
+    }
+    if (cur.at("status") != expected) {
+        msgs.push_back("status " + cur.at("status") + " instead of " + expected);
+        return msgs;
+    }
+    if (expected != "ok") {
+        return msgs;
+    }
+    auto val = [](const Record &r, const char *k) { return atof(r.at(k).c_str()); };
+    char buf[256];
+    for (auto metric: {"compress", "decompress"}) {
+        std::string m = metric;
+        double noise = std::max(val(cur, (m + "_noise").c_str()), val(base, (m + "_noise").c_str()));
+        double allowed = std::max(opt.threshold, 3 * noise);
+        double b = val(base, (m + "_MBps").c_str()), c = val(cur, (m + "_MBps").c_str());
+        if (c < b * (1 - allowed)) {
+            snprintf(buf, sizeof(buf), "%s %.1f -> %.1f MB/s (-%.1f%%, allowed %.1f%%)", metric, b, c,
+                     100 * (1 - c / b), 100 * allowed);
+            msgs.push_back(buf);
+        }
+    }
+    double b = val(base, "ratio"), c = val(cur, "ratio");
+    if (c < b * (1 - opt.ratioThreshold)) {
+        snprintf(buf, sizeof(buf), "ratio %.3f -> %.3f", b, c);
+        msgs.push_back(buf);
+    }
+    b = val(base, "peak_rss_KB"), c = val(cur, "peak_rss_KB");
+    if (c > b * (1 + opt.rssThreshold) + 1024) {
+        snprintf(buf, sizeof(buf), "peak RSS %.0f -> %.0f KB", b, c);
+        msgs.push_back(buf);
+    }
+    return msgs;
+}
+
+void usage() {
+    printf("Usage: sz_regression <options>\n");
+    printf("Options:\n");
+    printf("	-o <file> : write the results as JSON\n");
+    printf("	-b <file> : compare with a baseline written by -o, exit with 1 on regressions\n");
+    printf("	-D <kind> ... : synthetic datasets (default grf cloud smooth)\n");
+    printf("	-3 <nx> <ny> <nz> : dimensions of the datasets (default 64 64 64), -1, -2 and -4 work alike\n");
+    printf("	-a <algo> ... : algorithms, 0 ALGO_LORENZO_REG, 1 ALGO_INTERP_LORENZO, 2 ALGO_INTERP (default 2 0 1)\n");
+    printf("	-q <qoi> ... : QoI modes (default 0 1 2 3 4 5 6 7 8)\n");
+    printf("	-t <threads> ... : thread counts (default 1 4)\n");
+    printf("	-R <eb> : value range based relative error bound (default 1e-3)\n");
+    printf("	-r <reps> : repetitions per case (default 3)\n");
+    printf("	-L <seconds> : time limit per case (default 120)\n");
+    printf("	-T <fraction> : allowed throughput drop before accounting for noise (default 0.1)\n");
+    printf("* examples: \n");
+    printf("	sz_regression -o baseline.json\n");
+    printf("	sz_regression -b ../bench/regression_baseline.json -o current.json\n");
+    exit(0);
+}
+
+int main(int argc, char *argv[]) {
+    auto list = [&](int &i, auto parse) {
+        std::vector<decltype(parse(""))> v;
+        while (i + 1 < argc && argv[i + 1][0] != '-') {
+            v.push_back(parse(argv[++i]));
+        }
+        if (v.empty()) usage();
+        return v;
+    };
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-' || argv[i][2]) {
+            usage();
+        }
+        switch (argv[i][1]) {
+            case 'o':
+                if (++i >= argc) usage();
+                opt.outPath = argv[i];
+                break;
+            case 'b':
+                if (++i >= argc) usage();
+                opt.baselinePath = argv[i];
+                break;
+            case 'D':
+                opt.datasets = list(i, [](const char *s) { return std::string(s); });
+                break;
+            case '1':
+            case '2':
+            case '3':
+            case '4': {
+                int n = argv[i][1] - '0';
+                if (i + n >= argc) usage();
+                // fastest dimension first on the command line, as in sz
+                opt.dims.assign(n, 0);
+                for (int d = n - 1; d >= 0; d--) {
+                    opt.dims[d] = atol(argv[++i]);
+                }
+                break;
+            }
+            case 'a':
+                opt.algos = list(i, [](const char *s) { return atoi(s); });
+                break;
+            case 'q':
+                opt.qois = list(i, [](const char *s) { return atoi(s); });
+                break;
+            case 't':
+                opt.threads = list(i, [](const char *s) { return atoi(s); });
+                break;
+            case 'R':
+                if (++i >= argc) usage();
+                opt.relEB = atof(argv[i]);
+                break;
+            case 'r':
+                if (++i >= argc) usage();
+                opt.reps = std::max(1, atoi(argv[i]));
+                break;
+            case 'L':
+                if (++i >= argc) usage();
+                opt.timeout = std::max(1, atoi(argv[i]));
+                break;
+            case 'T':
+                if (++i >= argc) usage();
+                opt.threshold = atof(argv[i]);
+                break;
+            default:
+                usage();
+        }
+    }
+
+    std::map<std::string, Record> baseline;
+    if (opt.baselinePath) {
+        baseline = read_json(opt.baselinePath);
+    }
+    std::vector<Record> records;
+    int regressions = 0, failures = 0;
+    for (const auto &dataset: opt.datasets) {
+        for (auto algo: opt.algos) {
+            for (auto qoi: opt.qois) {
+                auto expected = expected_status(algo, qoi);
+                for (auto threads: opt.threads) {
+                    auto rec = run_isolated(dataset, algo, qoi, threads);
+                    printf("%-45s %-22s", rec["key"].c_str(), rec["status"].c_str());
+                    if (rec.count("ratio")) {
+                        printf(" cmp %9s MB/s  dec %9s MB/s  ratio %9s  rss %8s KB", rec["compress_MBps"].c_str(),
+                               rec["decompress_MBps"].c_str(), rec["ratio"].c_str(), rec["peak_rss_KB"].c_str());
+                    }
+                    printf("\n");
+                    failures += rec["status"] != expected;
+                    auto it = baseline.find(rec["key"]);
+                    if (it != baseline.end()) {
+                        for (const auto &msg: compare(rec, it->second, expected)) {
+                            printf("    REGRESSION: %s\n", msg.c_str());
+                            regressions++;
+                        }
+                    }
+                    records.push_back(rec);
+                }
+            }
+        }
+    }
+    if (opt.outPath) {
+        write_json(opt.outPath, records);
+    }
+    printf("%zu cases, %d not as expected, %d regressions\n", records.size(), failures, regressions);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#ifndef SZ3_IMPL_SZAXES_HPP
+#define SZ3_IMPL_SZAXES_HPP
+
+/**
+ * Automatic axis order (conf.autoAxes): the predictors and the speed of the compressors depend on which dimension is
+ * the fastest. A box of at most 512K elements around the center of the field is ranked by the mean absolute difference
+ * along every dimension, then compressed with the axes in the input order, with the smoothest dimension fastest,
+ * and with the smoothest dimension slowest. The field is transposed to the order that compresses the box best,
+ * if it beats the input order by more than 2%.
+ */
+
+#include "SZ3/api/impl/SZDispatcher.hpp"
+#include "SZ3/preprocessor/Transpose.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/Statistic.hpp"
+#include "SZ3/utils/Tile.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+// compression ratio of the box with its dimensions in the order of axes
+template<class T, SZ::uint N>
+double SZ_axes_estimate(const SZ::Config &conf, const std::vector<T> &box, const std::array<size_t, N> &dims,
+                        const std::array<size_t, N> &axes) {
+    std::vector<T> buffer(box.size());
+    SZ::Transpose<T, N>().transpose(box.data(), buffer.data(), dims, axes);
+    std::vector<size_t> trial_dims(N);
+    for (SZ::uint k = 0; k < N; k++) {
+        trial_dims[k] = dims[axes[k]];
+    }
+    SZ::Config trial = conf;
+    trial.setDims(trial_dims.begin(), trial_dims.end());
+    trial.openmp = false;
+    trial.dataStats = SZ::DataStats();
+    size_t cmpSize = 0;
+    char *cmpData = SZ_compress_dispatcher<T, N>(trial, buffer.data(), cmpSize);
+    delete[] cmpData;
+    return box.size() * sizeof(T) * 1.0 / std::max<size_t>(1, cmpSize);
+}
+
+// axis order for conf.autoAxes, empty if the input order is kept
+template<class T, SZ::uint N>
+std::vector<uint8_t> SZ_axes_choose(const SZ::Config &conf, const T *data) {
+    if (N == 1) {
+        return {};
+    }
+    SZ::Tile tile;
+    tile.dims = conf.dims;
+    size_t num = conf.num;
+    while (num > (1 << 19)) {
+        auto longest = std::max_element(tile.dims.begin(), tile.dims.end());
+        num = num / *longest * (*longest / 2);
+        *longest /= 2;
+    }
+    tile.start.resize(N);
+    for (SZ::uint d = 0; d < N; d++) {
+        tile.start[d] = (conf.dims[d] - tile.dims[d]) / 2;
+    }
+    std::vector<T> box(num);
+    SZ::tile_gather(data, conf.dims, tile, box.data());
+
+    std::array<size_t, N> dims, strides;
+    std::array<double, N> roughness;
+    for (SZ::uint d = 0; d < N; d++) {
+        dims[d] = tile.dims[d];
+    }
+    strides[N - 1] = 1;
+    for (int d = N - 2; d >= 0; d--) {
+        strides[d] = strides[d + 1] * dims[d + 1];
+    }
+    for (SZ::uint d = 0; d < N; d++) {
+        double sum = 0;
+        size_t count = 0;
+        for (size_t i = 0; i + strides[d] < num; i++) {
+            if ((i / strides[d]) % dims[d] + 1 < dims[d]) {
+                sum += std::fabs((double) box[i + strides[d]] - (double) box[i]);
+                count++;
+            }
+        }
+        // dimensions too short to measure are kept slow
+        roughness[d] = count ? sum / count : HUGE_VAL;
+    }
+
+    // the error bound of the field; EB_RATIO is not resolved yet, use a typical bound instead
+    SZ::Config trial = conf;
+    trial.qoi = 0;
+    trial.temporal = SZ::TemporalRef();
+    if (trial.errorBoundMode == SZ::EB_RATIO) {
+        trial.errorBoundMode = SZ::EB_REL;
+        trial.relErrorBound = 1e-3;
+    }
+    SZ::calAbsErrorBound(trial, data);
+    trial.errorBoundMode = SZ::EB_ABS;
+
+    std::array<size_t, N> identity, smooth_fast, smooth_slow;
+    std::iota(identity.begin(), identity.end(), 0);
+    smooth_fast = identity;
+    std::stable_sort(smooth_fast.begin(), smooth_fast.end(),
+                     [&](size_t a, size_t b) { return roughness[a] > roughness[b]; });
+    smooth_slow = smooth_fast;
+    std::reverse(smooth_slow.begin(), smooth_slow.end());
+
+    double base = SZ_axes_estimate<T, N>(trial, box, dims, identity);
+    auto best = identity;
+    double best_ratio = base;
+    for (const auto &axes: {smooth_fast, smooth_slow}) {
+        if (axes == identity || (axes == smooth_slow && smooth_slow == smooth_fast)) {
+            continue;
+        }
+        double ratio = SZ_axes_estimate<T, N>(trial, box, dims, axes);
+        if (ratio > best_ratio) {
+            best = axes;
+            best_ratio = ratio;
+        }
+    }
+    if (best == identity || best_ratio < base * 1.02) {
+#if SZ3_DEBUG_TIMINGS
+        printf("axes: input order kept, sample ratio %.2f\n", base);
+#endif
+        return {};
+    }
+#if SZ3_DEBUG_TIMINGS
+    printf("axes:");
+    for (auto a: best) {
+        printf(" %zu", a);
+    }
+    printf(", sample ratio %.2f instead of %.2f\n", best_ratio, base);
+#endif
+    return std::vector<uint8_t>(best.begin(), best.end());
+}
+
+#endif
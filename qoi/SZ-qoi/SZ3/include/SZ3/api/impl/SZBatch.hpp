@@ -0,0 +1,383 @@
+#ifndef SZ3_IMPL_SZBATCH_HPP
+#define SZ3_IMPL_SZBATCH_HPP
+
+/**
+ * Compression of many fields in one call.
+ * Every field is cut into slabs along dims[0] in proportion to its estimated cost, and the slabs of all fields
+ * are scheduled on one OpenMP thread team, largest first. Each field becomes a regular container
+ * (see SZ3/utils/Container.hpp) whose chunks are its slabs, and the containers are packed into one stream:
+ *
+ * header:
+ *   magic (8 bytes), version (uint32), header size (uint64, bytes before the payload)
+ *   field count (uint64)
+ *   field table, for each field:
+ *     name length (uint64), name, data type (uint8), offset and size of its container in the payload (uint64 x2)
+ *   xxhash64 of all header bytes above
+ * payload:
+ *   containers of the fields
+ */
+
+#include "SZ3/def.hpp"
+#include "SZ3/api/impl/SZImpl.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/Container.hpp"
+#include "SZ3/utils/Statistic.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+
+namespace SZ {
+
+    enum DATA_TYPE {
+        DATA_TYPE_FLOAT, DATA_TYPE_DOUBLE
+    };
+
+    template<class T>
+    struct data_type;
+    template<>
+    struct data_type<float> {
+        static constexpr uint8_t value = DATA_TYPE_FLOAT;
+    };
+    template<>
+    struct data_type<double> {
+        static constexpr uint8_t value = DATA_TYPE_DOUBLE;
+    };
+
+    // one field of a batch, data are not owned
+    struct FieldDesc {
+        FieldDesc() = default;
+
+        template<class T>
+        FieldDesc(const std::string &name, const Config &conf, T *data) :
+                name(name), conf(conf), type(data_type<T>::value), data(data) {}
+
+        size_t element_size() const {
+            return type == DATA_TYPE_FLOAT ? sizeof(float) : sizeof(double);
+        }
+
+        // release data allocated by SZ_decompress_batch
+        void free_data() {
+            if (type == DATA_TYPE_FLOAT) {
+                delete[] (float *) data;
+            } else {
+                delete[] (double *) data;
+            }
+            data = nullptr;
+        }
+
+        std::string name;
+        Config conf;
+        uint8_t type = DATA_TYPE_FLOAT;
+        void *data = nullptr;
+    };
+
+    constexpr char BATCH_MAGIC[8] = {'S', 'Z', '3', 'B', 'A', 'T', 'C', 'H'};
+    constexpr uint32_t BATCH_VERSION = 1;
+
+    // a slab [lo, hi) along dims[0] of a field
+    struct BatchUnit {
+        size_t field;
+        size_t lo, hi;
+        double cost;
+    };
+
+    struct BatchEntry {
+        std::string name;
+        uint8_t type;
+        size_t offset, size;    // of the container in the payload
+    };
+
+    /**
+     * Relative compression cost of one byte of the field.
+     * Rough figures of the 1-thread throughput in bench/regression_baseline.json, they only need to rank fields.
+     */
+    inline double batch_cost_per_byte(const Config &conf) {
+        double cost = 1;
+        if (conf.cmprAlgo == ALGO_INTERP_LORENZO) {
+            cost = 1.4;
+        } else if (conf.cmprAlgo == ALGO_LORENZO_DUALQUANT) {
+            cost = 0.5;
+        } else if (conf.cmprAlgo == ALGO_TEMPORAL) {
+            cost = 1.2;
+        } else if (conf.cmprAlgo == ALGO_WAVELET) {
+            cost = 2.3;
+        }
+        return conf.qoi > 0 ? 4.5 * cost : cost;
+    }
+
+    inline bool batch_check(const char *data, size_t size) {
+        return size >= sizeof(BATCH_MAGIC) && memcmp(data, BATCH_MAGIC, sizeof(BATCH_MAGIC)) == 0;
+    }
+
+    // parse and check the batch header, return offset of the payload
+    inline size_t batch_read(const char *data, size_t size, std::vector<BatchEntry> &entries) {
+        ProfileScope scope(STAGE_CONFIG);
+        const uchar *pos = (const uchar *) data + sizeof(BATCH_MAGIC);
+        uint32_t version;
+        uint64_t header_size, field_num, checksum;
+        size_t min_size = sizeof(BATCH_MAGIC) + sizeof(uint32_t) + 3 * sizeof(uint64_t);
+        if (!batch_check(data, size) || size < min_size) {
+            printf("Error, the data are not a batch of fields or are truncated\n");
+            exit(0);
+        }
+        read(version, pos);
+        read(header_size, pos);
+        if (header_size < min_size || header_size > size) {
+            printf("Error, the compressed data are truncated or corrupted\n");
+            exit(0);
+        }
+        memcpy(&checksum, data + header_size - sizeof(uint64_t), sizeof(uint64_t));
+        if (checksum != container_checksum(data, header_size - sizeof(uint64_t))) {
+            printf("Error, checksum mismatch in the header, the compressed data are corrupted\n");
+            exit(0);
+        }
+        if (version > BATCH_VERSION) {
+            printf("Error, batch version %u is not supported\n", version);
+            exit(0);
+        }
+        read(field_num, pos);
+        entries.resize(field_num);
+        for (auto &e: entries) {
+            uint64_t v;
+            read(v, pos);
+            e.name.assign((const char *) pos, v);
+            pos += v;
+            read(e.type, pos);
+            read(v, pos);
+            e.offset = v;
+            read(v, pos);
+            e.size = v;
+            if (e.offset + e.size > size - header_size) {
+                printf("Error, field %s exceeds the compressed data, the data may be truncated\n", e.name.c_str());
+                exit(0);
+            }
+        }
+        scope.add_bytes_in(header_size);
+        return header_size;
+    }
+}
+
+template<class T>
+char *SZ_compress_batch_unit(SZ::Config &conf, T *data, size_t &outSize) {
+    if (conf.N == 1) {
+        return SZ_compress_dispatcher<T, 1>(conf, data, outSize);
+    } else if (conf.N == 2) {
+        return SZ_compress_dispatcher<T, 2>(conf, data, outSize);
+    } else if (conf.N == 3) {
+        return SZ_compress_dispatcher<T, 3>(conf, data, outSize);
+    } else {
+        return SZ_compress_dispatcher<T, 4>(conf, data, outSize);
+    }
+}
+
+template<class T>
+void SZ_decompress_batch_chunk(const SZ::Config &conf, const SZ::ContainerChunk &chunk, size_t i, char *payload,
+                               T *decData) {
+    if (conf.N == 1) {
+        SZ_decompress_chunk<T, 1>(conf, chunk, i, payload, decData);
+    } else if (conf.N == 2) {
+        SZ_decompress_chunk<T, 2>(conf, chunk, i, payload, decData);
+    } else if (conf.N == 3) {
+        SZ_decompress_chunk<T, 3>(conf, chunk, i, payload, decData);
+    } else {
+        SZ_decompress_chunk<T, 4>(conf, chunk, i, payload, decData);
+    }
+}
+
+inline char *SZ_compress_batch_impl(std::vector<SZ::FieldDesc> &fields, size_t &outSize) {
+    size_t field_num = fields.size();
+    int nThreads = 1;
+#ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+#endif
+
+    // SZ_decompress_batch has no previous step to predict from, ALGO_TEMPORAL fields are key frames only
+    for (const auto &field: fields) {
+        if (field.conf.temporal.data) {
+            printf("Error, field %s: SZ_compress_batch does not support the previous step of ALGO_TEMPORAL\n", field.name.c_str());
+            exit(0);
+        }
+    }
+
+    // resolve the error bound of every field on the whole field, the slabs share it
+#pragma omp parallel for schedule(dynamic)
+    for (ptrdiff_t f = 0; f < (ptrdiff_t) field_num; f++) {
+        auto &conf = fields[f].conf;
+        if (conf.N > 4) {
+            for (int i = 4; i < conf.N; i++) {
+                conf.dims[3] *= conf.dims[i];
+            }
+            conf.dims.resize(4);
+            conf.N = 4;
+        }
+        conf.dataStats = SZ::DataStats();
+        conf.axes.clear();
+        if (conf.errorBoundMode == SZ::EB_RATIO) {
+            if (fields[f].type == SZ::DATA_TYPE_FLOAT) {
+                SZ_ratio_search(conf, (const float *) fields[f].data);
+            } else {
+                SZ_ratio_search(conf, (const double *) fields[f].data);
+            }
+        }
+        if (fields[f].type == SZ::DATA_TYPE_FLOAT) {
+            SZ::calAbsErrorBound(conf, (float *) fields[f].data);
+        } else {
+            SZ::calAbsErrorBound(conf, (double *) fields[f].data);
+        }
+    }
+
+    // a field is cut into slabs of about 1/4 of the average work per thread, slabs stay large enough to predict well
+    const size_t min_slab_elements = 1 << 18;
+    std::vector<double> field_cost(field_num);
+    double total_cost = 0;
+    for (size_t f = 0; f < field_num; f++) {
+        field_cost[f] = fields[f].conf.num * fields[f].element_size() * SZ::batch_cost_per_byte(fields[f].conf);
+        total_cost += field_cost[f];
+    }
+    double target_cost = total_cost / (4.0 * nThreads);
+    std::vector<SZ::BatchUnit> units;
+    std::vector<std::vector<size_t>> field_units(field_num);
+    for (size_t f = 0; f < field_num; f++) {
+        const auto &conf = fields[f].conf;
+        size_t slabs = target_cost > 0 ? (size_t) std::ceil(field_cost[f] / target_cost) : 1;
+        slabs = std::min(slabs, std::max<size_t>(1, conf.num / min_slab_elements));
+        slabs = std::max<size_t>(1, std::min(slabs, conf.dims[0]));
+        for (size_t s = 0; s < slabs; s++) {
+            size_t lo = s * conf.dims[0] / slabs, hi = (s + 1) * conf.dims[0] / slabs;
+            field_units[f].push_back(units.size());
+            units.push_back({f, lo, hi, field_cost[f] * (hi - lo) / conf.dims[0]});
+        }
+    }
+    std::vector<size_t> order(units.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return units[a].cost > units[b].cost; });
+
+    // largest units first on a shared queue, small fields fill the gaps at the end
+    std::vector<SZ::Config> unit_conf(units.size());
+    std::vector<char *> unit_data(units.size());
+    std::vector<size_t> unit_size(units.size());
+#pragma omp parallel for schedule(dynamic, 1)
+    for (ptrdiff_t k = 0; k < (ptrdiff_t) order.size(); k++) {
+        size_t u = order[k];
+        const auto &unit = units[u];
+        const auto &field = fields[unit.field];
+        auto dims = field.conf.dims;
+        size_t stride = field.conf.num / dims[0];
+        dims[0] = unit.hi - unit.lo;
+        unit_conf[u] = field.conf;
+        unit_conf[u].setDims(dims.begin(), dims.end());
+        unit_conf[u].openmp = false;
+        unit_conf[u].dataStats = SZ::DataStats();
+        if (field.type == SZ::DATA_TYPE_FLOAT) {
+            unit_data[u] = SZ_compress_batch_unit<float>(unit_conf[u], (float *) field.data + unit.lo * stride, unit_size[u]);
+        } else {
+            unit_data[u] = SZ_compress_batch_unit<double>(unit_conf[u], (double *) field.data + unit.lo * stride, unit_size[u]);
+        }
+    }
+
+    std::vector<char *> containers(field_num);
+    std::vector<size_t> container_size(field_num);
+#pragma omp parallel for schedule(dynamic)
+    for (ptrdiff_t f = 0; f < (ptrdiff_t) field_num; f++) {
+        std::vector<SZ::Config> chunk_conf;
+        std::vector<size_t> chunk_start, chunk_size;
+        std::vector<char *> chunk_data;
+        for (auto u: field_units[f]) {
+            chunk_conf.push_back(unit_conf[u]);
+            chunk_start.push_back(units[u].lo);
+            chunk_data.push_back(unit_data[u]);
+            chunk_size.push_back(unit_size[u]);
+        }
+        containers[f] = SZ::container_write(fields[f].conf, chunk_conf, chunk_start, chunk_data, chunk_size, container_size[f]);
+        for (auto cmp: chunk_data) {
+            delete[] cmp;
+        }
+    }
+
+    SZ::ProfileScope scope(SZ::STAGE_CONFIG);
+    size_t header_size = sizeof(SZ::BATCH_MAGIC) + sizeof(uint32_t) + 3 * sizeof(uint64_t);
+    size_t payload_size = 0;
+    for (size_t f = 0; f < field_num; f++) {
+        header_size += 3 * sizeof(uint64_t) + fields[f].name.size() + sizeof(uint8_t);
+        payload_size += container_size[f];
+    }
+    outSize = header_size + payload_size;
+    auto out = new SZ::uchar[outSize];
+    SZ::uchar *pos = out;
+    memcpy(pos, SZ::BATCH_MAGIC, sizeof(SZ::BATCH_MAGIC));
+    pos += sizeof(SZ::BATCH_MAGIC);
+    SZ::write(SZ::BATCH_VERSION, pos);
+    SZ::write((uint64_t) header_size, pos);
+    SZ::write((uint64_t) field_num, pos);
+    size_t offset = 0;
+    for (size_t f = 0; f < field_num; f++) {
+        SZ::write((uint64_t) fields[f].name.size(), pos);
+        memcpy(pos, fields[f].name.data(), fields[f].name.size());
+        pos += fields[f].name.size();
+        SZ::write(fields[f].type, pos);
+        SZ::write((uint64_t) offset, pos);
+        SZ::write((uint64_t) container_size[f], pos);
+        offset += container_size[f];
+    }
+    SZ::write((uint64_t) SZ::container_checksum(out, pos - out), pos);
+    for (size_t f = 0; f < field_num; f++) {
+        memcpy(pos, containers[f], container_size[f]);
+        pos += container_size[f];
+        delete[] containers[f];
+    }
+    scope.add_bytes_out(header_size);
+    return (char *) out;
+}
+
+inline std::vector<SZ::FieldDesc> SZ_decompress_batch_impl(char *cmpData, size_t cmpSize) {
+    std::vector<SZ::BatchEntry> entries;
+    char *payload = cmpData + SZ::batch_read(cmpData, cmpSize, entries);
+
+    std::vector<SZ::FieldDesc> fields(entries.size());
+    std::vector<std::vector<SZ::ContainerChunk>> chunks(entries.size());
+    std::vector<char *> chunk_payload(entries.size());
+    std::vector<std::pair<size_t, size_t>> units;  // (field, chunk)
+    for (size_t f = 0; f < entries.size(); f++) {
+        char *container = payload + entries[f].offset;
+        if (!SZ::container_check(container, entries[f].size)) {
+            printf("Error, field %s is not a container, the compressed data are corrupted\n", entries[f].name.c_str());
+            exit(0);
+        }
+        auto &field = fields[f];
+        field.name = entries[f].name;
+        field.type = entries[f].type;
+        chunk_payload[f] = container + SZ::container_read(container, entries[f].size, field.conf, chunks[f]);
+        if (field.type == SZ::DATA_TYPE_FLOAT) {
+            field.data = new float[field.conf.num];
+        } else {
+            field.data = new double[field.conf.num];
+        }
+        for (size_t i = 0; i < chunks[f].size(); i++) {
+            units.emplace_back(f, i);
+        }
+    }
+    std::stable_sort(units.begin(), units.end(), [&](const std::pair<size_t, size_t> &a, const std::pair<size_t, size_t> &b) {
+        return chunks[a.first][a.second].size > chunks[b.first][b.second].size;
+    });
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (ptrdiff_t k = 0; k < (ptrdiff_t) units.size(); k++) {
+        size_t f = units[k].first, i = units[k].second;
+        const auto &field = fields[f];
+        if (field.type == SZ::DATA_TYPE_FLOAT) {
+            SZ_decompress_batch_chunk<float>(field.conf, chunks[f][i], i, chunk_payload[f], (float *) field.data);
+        } else {
+            SZ_decompress_batch_chunk<double>(field.conf, chunks[f][i], i, chunk_payload[f], (double *) field.data);
+        }
+    }
+    return fields;
+}
+
+#endif
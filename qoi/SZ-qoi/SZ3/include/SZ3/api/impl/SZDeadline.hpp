@@ -0,0 +1,146 @@
+#ifndef SZ3_IMPL_SZDEADLINE_HPP
+#define SZ3_IMPL_SZDEADLINE_HPP
+
+/**
+ * Deadline mode: compress within conf.timeBudget seconds, or at conf.targetThroughput GB/s.
+ * The settings below go from the highest compression ratio to the highest throughput. The throughput of each is
+ * measured once per process, data type and QoI mode on the sampled sub-field of the first such field (the calibration
+ * run), and the first setting whose estimated time fits the rest of the budget is used for the field.
+ * With conf.autoAxes the sample is transposed to the chosen axis order first, the order the field is compressed in.
+ * ALGO_TEMPORAL keeps its algorithm, the decompression of the next step needs it.
+ * The chosen algorithm is stored in the config of the compressed data like any other setting.
+ */
+
+#include "SZ3/api/impl/SZDispatcher.hpp"
+#include "SZ3/api/impl/SZImplOMP.hpp"
+#include "SZ3/preprocessor/Transpose.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/Extraction.hpp"
+#include "SZ3/utils/Statistic.hpp"
+#include "SZ3/utils/Timer.hpp"
+#include <array>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace SZ {
+
+    struct SpeedTier {
+        const char *name;
+        uint8_t cmprAlgo;
+        uint8_t interpAlgo;
+        int losslessLevel;
+    };
+
+    const SpeedTier SPEED_TIERS[] = {
+            {"interpolation/lorenzo with tuning", ALGO_INTERP_LORENZO,    INTERP_ALGO_CUBIC,  3},
+            {"lorenzo/regression",                ALGO_LORENZO_REG,       INTERP_ALGO_CUBIC,  3},
+            {"linear interpolation",              ALGO_INTERP,            INTERP_ALGO_LINEAR, 3},
+            {"dual-quant lorenzo",                ALGO_LORENZO_DUALQUANT, INTERP_ALGO_CUBIC,  1},
+            {"dual-quant lorenzo, fast zstd",     ALGO_LORENZO_DUALQUANT, INTERP_ALGO_CUBIC,  -5},
+    };
+    const size_t SPEED_TIER_NUM = sizeof(SPEED_TIERS) / sizeof(SPEED_TIERS[0]);
+
+    inline void apply_speed_tier(Config &conf, const SpeedTier &tier) {
+        conf.cmprAlgo = tier.cmprAlgo;
+        conf.interpAlgo = tier.interpAlgo;
+        conf.losslessLevel = tier.losslessLevel;
+    }
+
+    // dual-quant lorenzo has no QoI, regional averages (qoi 3) need the blocks of lorenzo/regression
+    inline bool speed_tier_supports(const SpeedTier &tier, const Config &conf) {
+        return conf.qoi == 0 || (tier.cmprAlgo != ALGO_LORENZO_DUALQUANT && (conf.qoi != 3 || tier.cmprAlgo != ALGO_INTERP));
+    }
+}
+
+// throughput in bytes per second of every speed tier on one thread, measured on the first field of the QoI mode
+template<class T, SZ::uint N>
+const std::vector<double> &SZ_deadline_calibrate(const SZ::Config &conf, const T *data,
+                                                 const std::vector<uint8_t> &axes) {
+    static std::map<int, std::vector<double>> throughputs;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &throughput = throughputs[conf.qoi];
+    if (!throughput.empty()) {
+        return throughput;
+    }
+    auto view = SZ::make_sampling_view<T, N>(data, conf.dims);
+    std::vector<T> sample(view.sample_num);
+    SZ::sampling_gather(view, sample.data());
+    auto sample_dims = view.sample_dims;
+    if (axes.size() == N) {
+        // the sampled indices are chosen per dimension, the transposed sample is the sample of the transposed field
+        std::array<size_t, N> dims, order;
+        for (SZ::uint k = 0; k < N; k++) {
+            dims[k] = view.sample_dims[k];
+            order[k] = axes[k];
+            sample_dims[k] = view.sample_dims[axes[k]];
+        }
+        std::vector<T> transposed(sample.size());
+        SZ::Transpose<T, N>().transpose(sample.data(), transposed.data(), dims, order);
+        sample.swap(transposed);
+    }
+    throughput.assign(SZ::SPEED_TIER_NUM, 0);
+    for (size_t i = 0; i < SZ::SPEED_TIER_NUM; i++) {
+        if (!SZ::speed_tier_supports(SZ::SPEED_TIERS[i], conf)) {
+            continue;
+        }
+        SZ::Config trial = conf;
+        SZ::apply_speed_tier(trial, SZ::SPEED_TIERS[i]);
+        trial.setDims(sample_dims.begin(), sample_dims.end());
+        trial.openmp = false;
+        trial.dataStats = SZ::DataStats();
+        trial.temporal = SZ::TemporalRef();
+        std::vector<T> buffer(sample);
+        size_t cmpSize = 0;
+        SZ::Timer timer(true);
+        char *cmpData = SZ_compress_dispatcher<T, N>(trial, buffer.data(), cmpSize);
+        double seconds = timer.stop();
+        delete[] cmpData;
+        throughput[i] = sample.size() * sizeof(T) / std::max(seconds, 1e-9);
+    }
+    return throughput;
+}
+
+/*
+ * set the algorithm, tuning and lossless level of conf for its time budget
+ * axes is the order the field will be compressed in, empty for the input order; spent is the time already used.
+ */
+template<class T, SZ::uint N>
+void SZ_deadline_choose(SZ::Config &conf, const T *data, const std::vector<uint8_t> &axes = {}, double spent = 0) {
+    SZ::Timer timer(true);
+    double bytes = conf.num * sizeof(T);
+    double budget = conf.timeBudget > 0 ? conf.timeBudget : bytes / (conf.targetThroughput * 1e9);
+
+    // calibrate with the error bound of this field, or a typical one when it is not known yet
+    SZ::Config calib = conf;
+    if (calib.errorBoundMode == SZ::EB_RATIO) {
+        calib.errorBoundMode = SZ::EB_REL;
+        calib.relErrorBound = 1e-3;
+    }
+    SZ::calAbsErrorBound(calib, data);
+    const auto &throughput = SZ_deadline_calibrate<T, N>(calib, data, axes);
+
+    // tiles of the OpenMP path are compressed independently, one per thread
+    int nThreads = conf.openmp ? SZ_omp_threads(conf) : 1;
+    double left = budget - spent - timer.stop();
+    size_t choice = SZ::SPEED_TIER_NUM;
+    double estimate = 0;
+    for (size_t i = 0; i < SZ::SPEED_TIER_NUM; i++) {
+        if (!SZ::speed_tier_supports(SZ::SPEED_TIERS[i], conf)) {
+            continue;
+        }
+        choice = i;
+        estimate = bytes / (throughput[i] * nThreads);
+        if (estimate <= left) {
+            break;
+        }
+    }
+    SZ::apply_speed_tier(conf, SZ::SPEED_TIERS[choice]);
+#if SZ3_DEBUG_TIMINGS
+    printf("deadline: %s, estimated %.3f s, %.3f s left of %.3f s\n", SZ::SPEED_TIERS[choice].name, estimate,
+           left, budget);
+#endif
+}
+
+#endif
@@ -6,6 +6,9 @@
 #include "SZ3/utils/Config.hpp"
 #include "SZ3/api/impl/SZInterp.hpp"
 #include "SZ3/api/impl/SZLorenzoReg.hpp"
+#include "SZ3/api/impl/SZDualQuant.hpp"
+#include "SZ3/api/impl/SZTemporal.hpp"
+#include "SZ3/api/impl/SZWavelet.hpp"
 #include <cmath>
 
 
@@ -22,6 +25,12 @@ char *SZ_compress_dispatcher(SZ::Config &conf, T *data, size_t &outSize) {
         cmpData = (char *) SZ_compress_Interp<T, N>(conf, data, outSize);
     } else if (conf.cmprAlgo == SZ::ALGO_INTERP_LORENZO) {
         cmpData = (char *) SZ_compress_Interp_lorenzo<T, N>(conf, data, outSize);
+    } else if (conf.cmprAlgo == SZ::ALGO_LORENZO_DUALQUANT) {
+        cmpData = (char *) SZ_compress_DualQuant<T, N>(conf, data, outSize);
+    } else if (conf.cmprAlgo == SZ::ALGO_TEMPORAL) {
+        cmpData = (char *) SZ_compress_Temporal<T, N>(conf, data, outSize);
+    } else if (conf.cmprAlgo == SZ::ALGO_WAVELET) {
+        cmpData = (char *) SZ_compress_Wavelet<T, N>(conf, data, outSize);
     }
     return cmpData;
 }
@@ -33,6 +42,12 @@ void SZ_decompress_dispatcher(SZ::Config &conf, char *cmpData, size_t cmpSize, T
         SZ_decompress_LorenzoReg<T, N>(conf, cmpData, cmpSize, decData);
     } else if (conf.cmprAlgo == SZ::ALGO_INTERP) {
         SZ_decompress_Interp<T, N>(conf, cmpData, cmpSize, decData);
+    } else if (conf.cmprAlgo == SZ::ALGO_LORENZO_DUALQUANT) {
+        SZ_decompress_DualQuant<T, N>(conf, cmpData, cmpSize, decData);
+    } else if (conf.cmprAlgo == SZ::ALGO_TEMPORAL) {
+        SZ_decompress_Temporal<T, N>(conf, cmpData, cmpSize, decData);
+    } else if (conf.cmprAlgo == SZ::ALGO_WAVELET) {
+        SZ_decompress_Wavelet<T, N>(conf, cmpData, cmpSize, decData);
     } else {
         printf("SZ_decompress_dispatcher, Method not supported\n");
         exit(0);
@@ -0,0 +1,42 @@
+#ifndef SZ3_SZ_DUALQUANT_HPP
+#define SZ3_SZ_DUALQUANT_HPP
+
+#include "SZ3/compressor/SZGeneralCompressor.hpp"
+#include "SZ3/frontend/SZDualQuantFrontend.hpp"
+#include "SZ3/encoder/HuffmanEncoder.hpp"
+#include "SZ3/lossless/Lossless_zstd.hpp"
+#include "SZ3/utils/Statistic.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/def.hpp"
+#include <cmath>
+#include <memory>
+
+
+template<class T, SZ::uint N>
+char *SZ_compress_DualQuant(SZ::Config &conf, T *data, size_t &outSize) {
+
+    assert(N == conf.N);
+    assert(conf.cmprAlgo == SZ::ALGO_LORENZO_DUALQUANT);
+    SZ::calAbsErrorBound(conf, data);
+
+    if (conf.qoi > 0) {
+        printf("QoI is not supported by ALGO_LORENZO_DUALQUANT\n");
+        exit(0);
+    }
+    auto sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_dualquant_frontend<T, N>(conf), SZ::HuffmanEncoder<int>(),
+                                                   SZ::Lossless_zstd(conf.losslessLevel));
+    return (char *) sz->compress(conf, data, outSize);
+}
+
+
+template<class T, SZ::uint N>
+void SZ_decompress_DualQuant(const SZ::Config &conf, char *cmpData, size_t cmpSize, T *decData) {
+    assert(conf.cmprAlgo == SZ::ALGO_LORENZO_DUALQUANT);
+
+    SZ::uchar const *cmpDataPos = (SZ::uchar *) cmpData;
+    auto sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_dualquant_frontend<T, N>(conf), SZ::HuffmanEncoder<int>(),
+                                                   SZ::Lossless_zstd());
+    sz->decompress(cmpDataPos, cmpSize, decData);
+}
+
+#endif
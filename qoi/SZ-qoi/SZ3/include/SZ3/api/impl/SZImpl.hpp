@@ -4,21 +4,311 @@
 #include "SZ3/def.hpp"
 #include "SZ3/api/impl/SZDispatcher.hpp"
 #include "SZ3/api/impl/SZImplOMP.hpp"
+#include "SZ3/api/impl/SZAxes.hpp"
+#include "SZ3/api/impl/SZDeadline.hpp"
+#include "SZ3/api/impl/SZRatio.hpp"
+#include "SZ3/utils/Container.hpp"
+#include "SZ3/utils/Tile.hpp"
+#include "SZ3/preprocessor/Transpose.hpp"
 #include <cmath>
 
+/*
+ * compress data without modifying them
+ * The compressors overwrite their input with the reconstruction, so every tile is compressed from a scratch copy.
+ * By default the tiles are those of SZ_compress_impl (the whole field without OpenMP) and the output is the same as
+ * compressing in place; conf.preserveTileElements bounds the copy at the cost of more tile boundaries.
+ * With axes, conf.dims are the transposed dimensions and every tile is transposed from data (see SZ_compress_tiles).
+ */
+template<class T, SZ::uint N>
+char *SZ_compress_preserve_tiles(SZ::Config &conf, const T *data, size_t &outSize,
+                                 const std::vector<uint8_t> &axes = {}) {
+#ifndef _OPENMP
+    conf.openmp=false;
+#endif
+    SZ::calAbsErrorBound(conf, data);
+    int nThreads = conf.openmp ? SZ_omp_threads(conf) : 1;
+    std::vector<SZ::Tile> tiles;
+    if (conf.preserveTileElements > 0) {
+        size_t target = (conf.num + conf.preserveTileElements - 1) / conf.preserveTileElements;
+        if (nThreads > 1) {
+            target = std::max<size_t>(target, 4 * nThreads);
+        }
+        tiles = SZ::make_tiles(conf.dims, target, conf.openmp ? 1 << 16 : conf.preserveTileElements / 4);
+    } else {
+        // same as SZ_compress_OMP
+        tiles = SZ::make_tiles(conf.dims, nThreads == 1 ? 1 : 4 * nThreads, 1 << 16);
+    }
+    return SZ_compress_tiles<T, N>(conf, data, nullptr, tiles, nThreads, outSize, axes);
+}
+
+/*
+ * EB_RATIO final correction: the sample does not always predict the ratio of the whole field, so compress the whole
+ * field without modifying it and search again on these ratios, until one is within conf.ratioTolerance or after
+ * 6 compressions. The first step follows the slope found on the sample, then the target is bracketed and narrowed.
+ * Returns the compressed data closest to the target; conf.absErrorBound is set to its error bound.
+ */
+template<class T, SZ::uint N>
+char *SZ_ratio_correct(SZ::Config &conf, const T *data, double slope, size_t &outSize,
+                       const std::vector<uint8_t> &axes = {}) {
+    const double y_target = std::log(conf.targetRatio);
+    char *best = nullptr;
+    double best_x = 0, best_y = 0;
+    bool has_lo = false, has_hi = false;
+    double lo_x = 0, lo_y = 0, hi_x = 0, hi_y = 0;
+    double range = SZ::get_data_stats(conf, data).range;
+    if (!(range > 0)) {
+        range = 1;
+    }
+    const double x_min = std::log(range * 1e-9), x_max = std::log(range);
+    double x = std::log(conf.absErrorBound);
+    for (int iter = 0; iter < 6; iter++) {
+        double trial_x = x;
+        SZ::Config trial = conf;
+        trial.absErrorBound = std::exp(x);
+        size_t cmpSize = 0;
+        char *cmpData = SZ_compress_preserve_tiles<T, N>(trial, data, cmpSize, axes);
+        double y = std::log(conf.num * sizeof(T) * 1.0 / cmpSize);
+#if SZ3_DEBUG_TIMINGS
+        printf("EB_RATIO: eb = %g, ratio = %.2f, target = %.2f\n", trial.absErrorBound, std::exp(y), conf.targetRatio);
+#endif
+        if (best == nullptr || std::fabs(y - y_target) < std::fabs(best_y - y_target)) {
+            delete[] best;
+            best = cmpData;
+            best_x = x;
+            best_y = y;
+            outSize = cmpSize;
+        } else {
+            delete[] cmpData;
+        }
+        if (std::fabs(std::exp(y - y_target) - 1) <= conf.ratioTolerance) {
+            break;
+        }
+        if (y < y_target) {
+            has_lo = true;
+            lo_x = x;
+            lo_y = y;
+        } else {
+            has_hi = true;
+            hi_x = x;
+            hi_y = y;
+        }
+        if (has_lo && has_hi) {
+            x = lo_x + (y_target - lo_y) * (hi_x - lo_x) / (hi_y - lo_y);
+            x = std::min(std::max(x, lo_x + 0.1 * (hi_x - lo_x)), hi_x - 0.1 * (hi_x - lo_x));
+        } else {
+            x += std::min(std::max((y_target - y) / slope, -std::log(100.0)), std::log(100.0));
+        }
+        double next = std::min(std::max(x, x_min), x_max);
+        if (next == trial_x) {
+            // the ratio does not reach the target within the range of error bounds
+            break;
+        }
+        x = next;
+    }
+    conf.absErrorBound = std::exp(best_x);
+    return best;
+}
+
+// decompress chunk i of a container into decData, the whole field of conf
+template<class T, SZ::uint N>
+void SZ_decompress_chunk(const SZ::Config &conf, const SZ::ContainerChunk &chunk, size_t i, char *payload, T *decData) {
+    size_t stride = conf.num / conf.dims[0];
+    if (!SZ::container_verify_chunk(payload, chunk)) {
+        printf("Error, checksum mismatch in chunk %zu, the compressed data are corrupted\n", i);
+        exit(0);
+    }
+    SZ::Config chunk_conf;
+    const SZ::uchar *pos = (SZ::uchar *) payload + chunk.offset;
+    chunk_conf.load(pos);
+    chunk_conf.temporal.step = conf.temporal.step;
+    bool temporal = conf.temporal.data && conf.temporal.num == conf.num;
+    char *chunk_data = payload + chunk.offset + chunk.confSize;
+    size_t chunk_size = chunk.size - chunk.confSize;
+
+    SZ::Tile tile;
+    tile.start = chunk.starts;
+    tile.dims = chunk.dims;
+    if (SZ::tile_is_slab(conf.dims, tile)) {
+        if (temporal) {
+            chunk_conf.temporal.data = (const T *) conf.temporal.data + chunk.start * stride;
+            chunk_conf.temporal.num = chunk_conf.num;
+        }
+        SZ_decompress_dispatcher<T, N>(chunk_conf, chunk_data, chunk_size, decData + chunk.start * stride);
+        return;
+    }
+    std::vector<T> buffer(chunk_conf.num), prev;
+    if (temporal) {
+        prev.resize(chunk_conf.num);
+        SZ::tile_gather((const T *) conf.temporal.data, conf.dims, tile, prev.data());
+        chunk_conf.temporal.data = prev.data();
+        chunk_conf.temporal.num = prev.size();
+    }
+    SZ_decompress_dispatcher<T, N>(chunk_conf, chunk_data, chunk_size, buffer.data());
+    SZ::tile_scatter(buffer.data(), conf.dims, tile, decData);
+}
+
+/*
+ * decompress the chunks of a container into decData
+ * Chunks are independent, the threads of the reader (conf.nThreads or the OpenMP default) pull them one by one,
+ * however many threads compressed them.
+ */
+template<class T, SZ::uint N>
+void SZ_decompress_container(const SZ::Config &conf, const std::vector<SZ::ContainerChunk> &chunks,
+                             char *payload, T *decData) {
+    int nThreads = SZ_omp_threads(conf);
+    bool parallel = nThreads > 1 && chunks.size() > 1;
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads) if(parallel)
+    for (ptrdiff_t i = 0; i < (ptrdiff_t) chunks.size(); i++) {
+        SZ_decompress_chunk<T, N>(conf, chunks[i], i, payload, decData);
+    }
+}
+
+// decompress a container into decData in the axis order of the input, conf.dims are set to it
+template<class T, SZ::uint N>
+void SZ_decompress_field(SZ::Config &conf, const std::vector<SZ::ContainerChunk> &chunks, char *payload, T *decData) {
+    if (conf.axes.size() != N) {
+        SZ_decompress_container<T, N>(conf, chunks, payload, decData);
+        return;
+    }
+    std::vector<T> buffer(conf.num);
+    SZ_decompress_container<T, N>(conf, chunks, payload, buffer.data());
+    std::array<size_t, N> dims, inverse;
+    std::vector<size_t> input_dims(N);
+    for (SZ::uint k = 0; k < N; k++) {
+        dims[k] = conf.dims[k];
+        inverse[conf.axes[k]] = k;
+        input_dims[conf.axes[k]] = conf.dims[k];
+    }
+    SZ::Transpose<T, N>(SZ_omp_threads(conf)).transpose(buffer.data(), decData, dims, inverse);
+    conf.setDims(input_dims.begin(), input_dims.end());
+}
+
+/*
+ * the axis order of conf.autoAxes, empty for the input order, then the settings of the deadline mode, calibrated in
+ * that order with the time the axis choice took; ALGO_TEMPORAL keeps both
+ */
+template<class T, SZ::uint N>
+std::vector<uint8_t> SZ_choose_settings(SZ::Config &conf, const T *data) {
+    std::vector<uint8_t> axes;
+    if (conf.cmprAlgo == SZ::ALGO_TEMPORAL) {
+        return axes;
+    }
+    SZ::Timer timer(true);
+    if (conf.autoAxes) {
+        axes = SZ_axes_choose<T, N>(conf, data);
+    }
+    if (conf.timeBudget > 0 || conf.targetThroughput > 0) {
+        SZ_deadline_choose<T, N>(conf, data, axes, timer.stop());
+    }
+    return axes;
+}
+
+template<class T, SZ::uint N>
+char *SZ_compress_impl(SZ::Config &conf, T *data, size_t &outSize);
+
+// conf for the field transposed to axes, the deadline choice and the axis order are already resolved
+inline SZ::Config SZ_axes_config(const SZ::Config &conf, const std::vector<uint8_t> &axes) {
+    std::vector<size_t> transposed_dims(axes.size());
+    for (size_t k = 0; k < axes.size(); k++) {
+        transposed_dims[k] = conf.dims[axes[k]];
+    }
+    SZ::Config conf_t = conf;
+    conf_t.setDims(transposed_dims.begin(), transposed_dims.end());
+    conf_t.autoAxes = false;
+    conf_t.timeBudget = 0;
+    conf_t.targetThroughput = 0;
+    conf_t.axes = axes;
+    return conf_t;
+}
+
+/*
+ * compress data transposed to axes (see SZ3/api/impl/SZAxes.hpp) and overwrite them with the reconstruction,
+ * the container records the axis order; conf keeps the dimensions of the input.
+ * The field is transposed into a copy of the same size, which is compressed in place and transposed back.
+ */
+template<class T, SZ::uint N>
+char *SZ_compress_axes(SZ::Config &conf, T *data, const std::vector<uint8_t> &axes, size_t &outSize) {
+    std::array<size_t, N> dims, order, transposed_dims, inverse;
+    for (SZ::uint k = 0; k < N; k++) {
+        dims[k] = conf.dims[k];
+        order[k] = axes[k];
+        transposed_dims[k] = conf.dims[axes[k]];
+        inverse[axes[k]] = k;
+    }
+    SZ::Transpose<T, N> transpose(conf.openmp ? SZ_omp_threads(conf) : 1);
+    std::vector<T> buffer(conf.num);
+    transpose.transpose(data, buffer.data(), dims, order);
+
+    SZ::Config conf_t = SZ_axes_config(conf, axes);
+    char *cmpData = SZ_compress_impl<T, N>(conf_t, buffer.data(), outSize);
+    transpose.transpose(buffer.data(), data, transposed_dims, inverse);
+    // keep what the compression resolved, such as the error bound of EB_RATIO
+    auto input_dims = conf.dims;
+    conf = conf_t;
+    conf.setDims(input_dims.begin(), input_dims.end());
+    return cmpData;
+}
+
 template<class T, SZ::uint N>
 char *SZ_compress_impl(SZ::Config &conf, T *data, size_t &outSize) {
 #ifndef _OPENMP
     conf.openmp=false;
 #endif
+    auto axes = SZ_choose_settings<T, N>(conf, data);
+    if (!axes.empty()) {
+        return SZ_compress_axes<T, N>(conf, data, axes, outSize);
+    }
+    if (conf.errorBoundMode == SZ::EB_RATIO) {
+        double slope = SZ_ratio_search<T, N>(conf, data);
+        if (conf.ratioCorrection) {
+            // data must hold the reconstruction of the returned stream, which is what its decompression gives
+            char *cmpData = SZ_ratio_correct<T, N>(conf, data, slope, outSize);
+            SZ::Config dec_conf;
+            std::vector<SZ::ContainerChunk> chunks;
+            size_t header_size = SZ::container_read(cmpData, outSize, dec_conf, chunks);
+            dec_conf.temporal = conf.temporal;
+            dec_conf.nThreads = conf.openmp ? conf.nThreads : 1;
+            SZ_decompress_container<T, N>(dec_conf, chunks, cmpData + header_size, data);
+            return cmpData;
+        }
+    }
     if (conf.openmp) {
         return SZ_compress_OMP<T, N>(conf, data, outSize);
     } else {
-        return SZ_compress_dispatcher<T, N>(conf, data, outSize);
+        // one chunk for the whole field, written as by SZ_compress_OMP and SZ_compress_preserve_tiles
+        SZ::calAbsErrorBound(conf, data);
+        auto tiles = SZ::make_tiles(conf.dims, 1, 1);
+        return SZ_compress_tiles<T, N>(conf, data, data, tiles, 1, outSize);
     }
 }
 
+template<class T, SZ::uint N>
+char *SZ_compress_preserve_impl(SZ::Config &conf, const T *data, size_t &outSize) {
+#ifndef _OPENMP
+    conf.openmp=false;
+#endif
+    auto axes = SZ_choose_settings<T, N>(conf, data);
+    bool correct = conf.errorBoundMode == SZ::EB_RATIO && conf.ratioCorrection;
+    double slope = 0;
+    if (conf.errorBoundMode == SZ::EB_RATIO) {
+        // the sample search runs in the input order, the tiles are transposed one by one below
+        slope = SZ_ratio_search<T, N>(conf, data);
+    }
+    SZ::Config conf_t = axes.empty() ? conf : SZ_axes_config(conf, axes);
+    char *cmpData;
+    if (correct) {
+        cmpData = SZ_ratio_correct<T, N>(conf_t, data, slope, outSize, axes);
+    } else {
+        cmpData = SZ_compress_preserve_tiles<T, N>(conf_t, data, outSize, axes);
+    }
+    // keep what the compression resolved, such as the error bound of EB_RATIO
+    auto input_dims = conf.dims;
+    conf = conf_t;
+    conf.setDims(input_dims.begin(), input_dims.end());
+    return cmpData;
+}
 
+// decompress data written before the container format
 template<class T, SZ::uint N>
 void SZ_decompress_impl(SZ::Config &conf, char *cmpData, size_t cmpSize, T *decData) {
 #ifndef _OPENMP
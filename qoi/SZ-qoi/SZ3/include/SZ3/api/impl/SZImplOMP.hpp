@@ -2,142 +2,190 @@
 #define SZ3_IMPL_SZDISPATCHER_OMP_HPP
 
 #include "SZ3/api/impl/SZDispatcher.hpp"
+#include "SZ3/preprocessor/Transpose.hpp"
+#include "SZ3/utils/Container.hpp"
+#include "SZ3/utils/Tile.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <memory>
+#include <numeric>
 
 
 #include "omp.h"
 
-template<class T, SZ::uint N>
-char *SZ_compress_OMP(SZ::Config &conf, T *data, size_t &outSize) {
-    unsigned char *compressed, *compressed_pos;
+// threads used by the OpenMP paths, conf.nThreads or the OpenMP default
+inline int SZ_omp_threads(const SZ::Config &conf) {
 #ifdef _OPENMP
+    return conf.nThreads > 0 ? conf.nThreads : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
 
-    assert(N == conf.N);
-    if (conf.errorBoundMode != SZ::EB_ABS && conf.errorBoundMode != SZ::EB_REL) {
-        printf("Error, error bound mode not supported\n");
-        exit(0);
+/*
+ * compress the tiles of data on nThreads threads, largest sampled cost first, into a container with one chunk per tile
+ * conf.absErrorBound must be set. The reconstruction goes to writable, which is data itself when the input may be
+ * overwritten; with writable == nullptr data are not modified and every tile is compressed from a scratch copy,
+ * so the extra memory is bounded by the nThreads largest tiles.
+ * With axes (writable == nullptr only), conf.dims and tiles are in the transposed order of SZ3/api/impl/SZAxes.hpp
+ * while data stay in the input order: every tile is gathered from its box in data and transposed.
+ */
+template<class T, SZ::uint N>
+char *SZ_compress_tiles(SZ::Config &conf, const T *data, T *writable, std::vector<SZ::Tile> &tiles, int nThreads,
+                        size_t &outSize, const std::vector<uint8_t> &axes = {}) {
+    size_t tile_num = tiles.size();
+    bool parallel = nThreads > 1 && tile_num > 1;
+    bool transposed = axes.size() == N;
+    std::vector<size_t> input_dims = conf.dims;
+    std::array<size_t, N> axes_order;
+    for (SZ::uint k = 0; transposed && k < N; k++) {
+        input_dims[axes[k]] = conf.dims[k];
+        axes_order[k] = axes[k];
     }
-
-    std::vector<char *> compressed_t;
-    std::vector<size_t> cmp_size_t, cmp_start_t;
-    std::vector<T> min_t, max_t;
-    std::vector<SZ::Config> conf_t;
-
-    int nThreads = 1;
-    double eb;
-#pragma omp parallel
-    {
-#pragma omp single
-        {
-            nThreads = omp_get_num_threads();
-            if (conf.dims[0] < nThreads) {
-                nThreads = conf.dims[0];
-            }
-            printf("nThreads = %d\n", nThreads);
-            compressed_t.resize(nThreads);
-            cmp_size_t.resize(nThreads);
-            cmp_start_t.resize(nThreads + 1);
-            conf_t.resize(nThreads);
-            min_t.resize(nThreads);
-            max_t.resize(nThreads);
+    // the box of a tile in the input order
+    auto input_box = [&](const SZ::Tile &tile) {
+        SZ::Tile box = tile;
+        for (SZ::uint k = 0; transposed && k < N; k++) {
+            box.start[axes[k]] = tile.start[k];
+            box.dims[axes[k]] = tile.dims[k];
         }
-
-
-        int tid = omp_get_thread_num();
-
-        auto dims_t = conf.dims;
-        int lo = tid * conf.dims[0] / nThreads;
-        int hi = (tid + 1) * conf.dims[0] / nThreads;
-        dims_t[0] = hi - lo;
-        auto it = dims_t.begin();
-        size_t num_t_base = std::accumulate(++it, dims_t.end(), (size_t) 1, std::multiplies<size_t>());
-        size_t num_t = dims_t[0] * num_t_base;
-
-        T *data_t = data + lo * num_t_base;
-        if (conf.errorBoundMode == SZ::EB_REL) {
-            auto minmax = std::minmax_element(data_t, data_t + num_t);
-            min_t[tid] = *minmax.first;
-            max_t[tid] = *minmax.second;
-#pragma omp barrier
-#pragma omp single
-            {
-                double range = *std::max_element(max_t.begin(), max_t.end()) - *std::min_element(min_t.begin(), min_t.end());
-                conf.absErrorBound = conf.relErrorBound * range;
-                conf.errorBoundMode = SZ::EB_ABS;
-//                std::cout << "error bound = " << eb << ", range = " << range << std::endl;
-            }
+        return box;
+    };
+    // the cost only orders the tiles
+    if (tile_num > 1) {
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads) if(parallel)
+        for (ptrdiff_t t = 0; t < (ptrdiff_t) tile_num; t++) {
+            tiles[t].cost = SZ::tile_cost(data, input_dims, input_box(tiles[t]), conf.absErrorBound);
         }
-
-        conf_t[tid] = conf;
-        conf_t[tid].setDims(dims_t.begin(), dims_t.end());
-        compressed_t[tid] = SZ_compress_dispatcher<T, N>(conf_t[tid], data_t, cmp_size_t[tid]);
-
-#pragma omp barrier
-#pragma omp single
-        {
-
-            cmp_start_t[0] = 0;
-            for (int i = 1; i <= nThreads; i++) {
-                cmp_start_t[i] = cmp_start_t[i - 1] + cmp_size_t[i - 1];
+    }
+    std::vector<size_t> order(tile_num);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return tiles[a].cost > tiles[b].cost; });
+
+    std::vector<char *> compressed_t(tile_num);
+    std::vector<size_t> cmp_size_t(tile_num);
+    std::vector<std::vector<size_t>> cmp_start_t(tile_num);
+    std::vector<SZ::Config> conf_t(tile_num);
+    size_t stride = conf.num / conf.dims[0];
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nThreads) if(parallel)
+    for (ptrdiff_t k = 0; k < (ptrdiff_t) tile_num; k++) {
+        size_t t = order[k];
+        const auto &tile = tiles[t];
+        cmp_start_t[t] = tile.start;
+        conf_t[t] = conf;
+        conf_t[t].setDims(tile.dims.begin(), tile.dims.end());
+        if (writable && SZ::tile_is_slab(conf.dims, tile)) {
+            if (conf.temporal.data) {
+                conf_t[t].temporal.data = (const T *) conf.temporal.data + tile.start[0] * stride;
+                conf_t[t].temporal.num = conf_t[t].num;
+            }
+            compressed_t[t] = SZ_compress_dispatcher<T, N>(conf_t[t], writable + tile.start[0] * stride, cmp_size_t[t]);
+        } else {
+            // the compressors overwrite their input with the reconstruction, give them a copy of the tile
+            std::vector<T> buffer(conf_t[t].num), prev;
+            if (transposed) {
+                auto box = input_box(tile);
+                std::array<size_t, N> box_dims;
+                std::copy(box.dims.begin(), box.dims.end(), box_dims.begin());
+                if (conf_t[t].num == conf.num) {
+                    SZ::Transpose<T, N>().transpose(data, buffer.data(), box_dims, axes_order);
+                } else {
+                    std::vector<T> gathered(conf_t[t].num);
+                    SZ::tile_gather(data, input_dims, box, gathered.data());
+                    SZ::Transpose<T, N>().transpose(gathered.data(), buffer.data(), box_dims, axes_order);
+                }
+            } else {
+                SZ::tile_gather(data, conf.dims, tile, buffer.data());
+            }
+            if (conf.temporal.data) {
+                prev.resize(conf_t[t].num);
+                SZ::tile_gather((const T *) conf.temporal.data, conf.dims, tile, prev.data());
+                conf_t[t].temporal.data = prev.data();
+                conf_t[t].temporal.num = prev.size();
             }
-            compressed = new unsigned char[sizeof(int) + (nThreads) * 120 + cmp_start_t[nThreads]];
-            compressed_pos = compressed;
-            SZ::write(nThreads, compressed_pos);
-            for (int i = 0; i < nThreads; i++) {
-                conf_t[i].save(compressed_pos);
+            compressed_t[t] = SZ_compress_dispatcher<T, N>(conf_t[t], buffer.data(), cmp_size_t[t]);
+            if (writable) {
+                SZ::tile_scatter(buffer.data(), conf.dims, tile, writable);
             }
-            SZ::write(cmp_size_t.data(), nThreads, compressed_pos);
         }
+    }
+
+    char *compressed = SZ::container_write(conf, conf_t, cmp_start_t, compressed_t, cmp_size_t, outSize);
+    for (auto cmp: compressed_t) {
+        delete[] cmp;
+    }
+    return compressed;
+}
+
+/*
+ * The field is cut into about 4 tiles per thread (see SZ3/utils/Tile.hpp), along any dimension if dims[0] is too short.
+ * Tiles are ordered by their sampled cost and compressed on the thread team largest first, so that sparse and
+ * dense parts of the field even out across threads. Every tile becomes one chunk of the container.
+ */
+template<class T, SZ::uint N>
+char *SZ_compress_OMP(SZ::Config &conf, T *data, size_t &outSize) {
+    char *compressed = nullptr;
+#ifdef _OPENMP
 
-        memcpy(compressed_pos + cmp_start_t[tid], compressed_t[tid], cmp_size_t[tid]);
-        delete[] compressed_t[tid];
+    assert(N == conf.N);
+    if (conf.errorBoundMode != SZ::EB_ABS && conf.errorBoundMode != SZ::EB_REL) {
+        printf("Error, error bound mode not supported\n");
+        exit(0);
     }
 
-    outSize = compressed_pos - compressed + cmp_start_t[nThreads];
+    // the range for EB_REL comes from one parallel pass over the whole field
+    SZ::calAbsErrorBound(conf, data);
+
+    int nThreads = SZ_omp_threads(conf);
+    printf("nThreads = %d\n", nThreads);
+    // tiles smaller than this lose too much compression ratio to their boundaries
+    const size_t min_tile_elements = 1 << 16;
+    auto tiles = SZ::make_tiles(conf.dims, nThreads == 1 ? 1 : 4 * nThreads, min_tile_elements);
+    compressed = SZ_compress_tiles<T, N>(conf, data, data, tiles, nThreads, outSize);
     std::cout << "Compressed size = " << outSize << std::endl;
 #endif
-    return (char *) compressed;
+    return compressed;
 }
 
-
+// decompress data written by SZ_compress_OMP before the container format, the slabs are independent
+// and decompressed with the threads of the reader, not the number of slabs the writer used
 template<class T, SZ::uint N>
 void SZ_decompress_OMP(const SZ::Config &conf, char *cmpData, size_t cmpSize, T *decData) {
 #ifdef _OPENMP
 
     const unsigned char *cmpr_data_pos = (unsigned char *) cmpData;
-    int nThreads = 1;
-    SZ::read(nThreads, cmpr_data_pos);
-    omp_set_num_threads(nThreads);
+    int nSlabs = 1;
+    SZ::read(nSlabs, cmpr_data_pos);
+    int nThreads = std::min(SZ_omp_threads(conf), nSlabs);
     printf("nThreads = %d\n", nThreads);
 
-    std::vector<SZ::Config> conf_t(nThreads);
-    for (int i = 0; i < nThreads; i++) {
+    std::vector<SZ::Config> conf_t(nSlabs);
+    for (int i = 0; i < nSlabs; i++) {
         conf_t[i].load(cmpr_data_pos);
     }
 
     std::vector<size_t> cmp_start_t, cmp_size_t;
-    cmp_size_t.resize(nThreads);
-    SZ::read(cmp_size_t.data(), nThreads, cmpr_data_pos);
+    cmp_size_t.resize(nSlabs);
+    SZ::read(cmp_size_t.data(), nSlabs, cmpr_data_pos);
     char *cmpr_data_p = cmpData + (cmpr_data_pos - (unsigned char *) cmpData);
 
-    cmp_start_t.resize(nThreads + 1);
+    cmp_start_t.resize(nSlabs + 1);
     cmp_start_t[0] = 0;
-    for (int i = 1; i <= nThreads; i++) {
+    for (int i = 1; i <= nSlabs; i++) {
         cmp_start_t[i] = cmp_start_t[i - 1] + cmp_size_t[i - 1];
     }
 
-#pragma omp parallel
-    {
-        int tid = omp_get_thread_num();
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+    for (int i = 0; i < nSlabs; i++) {
         auto dims_t = conf.dims;
-        int lo = tid * conf.dims[0] / nThreads;
-        int hi = (tid + 1) * conf.dims[0] / nThreads;
+        int lo = i * conf.dims[0] / nSlabs;
+        int hi = (i + 1) * conf.dims[0] / nSlabs;
         dims_t[0] = hi - lo;
         auto it = dims_t.begin();
         size_t num_t_base = std::accumulate(++it, dims_t.end(), (size_t) 1, std::multiplies<size_t>());
 
-        SZ_decompress_dispatcher<T, N>(conf_t[tid], cmpr_data_p + cmp_start_t[tid], cmp_size_t[tid], decData + lo * num_t_base);
+        SZ_decompress_dispatcher<T, N>(conf_t[i], cmpr_data_p + cmp_start_t[i], cmp_size_t[i], decData + lo * num_t_base);
     }
 #endif
 }
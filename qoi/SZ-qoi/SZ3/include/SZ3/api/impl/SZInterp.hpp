@@ -14,6 +14,7 @@
 #include "SZ3/utils/Extraction.hpp"
 #include "SZ3/utils/QuantOptimizatioin.hpp"
 #include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/api/impl/SZLorenzoReg.hpp"
 #include <cmath>
 #include <memory>
@@ -29,6 +30,11 @@ char *SZ_compress_Interp(SZ::Config &conf, T *data, size_t &outSize) {
 
     assert(N == conf.N);
     assert(conf.cmprAlgo == SZ::ALGO_INTERP);
+    if (conf.qoi == 3) {
+        // the regional averages are tracked per block by the lorenzo/regression compressors
+        printf("QoI 3 (regional average) is not supported by ALGO_INTERP, use ALGO_LORENZO_REG or ALGO_INTERP_LORENZO\n");
+        exit(0);
+    }
     SZ::calAbsErrorBound(conf, data);
 
     // conf.print();
@@ -39,28 +45,31 @@ char *SZ_compress_Interp(SZ::Config &conf, T *data, size_t &outSize) {
         auto quantizer_eb = SZ::EBLogQuantizer<T>(conf.qoiEBBase, conf.qoiEBLogBase, conf.qoiQuantbinCnt / 2);
         auto qoi = SZ::GetQOI<T, N>(conf);
         auto sz = SZ::SZQoIInterpolationCompressor<T, N, SZ::VariableEBLinearQuantizer<T, T>, SZ::EBLogQuantizer<T>, SZ::QoIEncoder<int>, SZ::Lossless_zstd>(
-                quantizer, quantizer_eb, qoi, SZ::QoIEncoder<int>(), SZ::Lossless_zstd());
+                quantizer, quantizer_eb, qoi, SZ::QoIEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
         // use sampling to determine abs bound
         {
+            SZ::ProfileScope tuning(SZ::STAGE_TUNING, conf.num * sizeof(T));
             auto dims = conf.dims;
             auto tmp_abs_eb = conf.absErrorBound;
 
-            size_t sampling_num, sampling_block;
-            std::vector<size_t> sample_dims(N);
-            std::vector<T> samples = SZ::sampling<T, N>(data, conf.dims, sampling_num, sample_dims, sampling_block);
+            // the trials compress the samples from source without modifying them, work holds their reconstruction
+            auto samples = SZ::make_sampling_view<T, N>(data, conf.dims);
+            size_t sampling_num = samples.sample_num;
+            std::vector<size_t> sample_dims = samples.sample_dims;
             conf.setDims(sample_dims.begin(), sample_dims.end());
 
-            T * sampling_data = (T *) malloc(sampling_num * sizeof(T));
+            std::vector<T> gathered;
+            const T *source = SZ::sampling_source(samples, gathered);
+            std::vector<T> work(sampling_num);
             // reset dimensions for average of square
             if(conf.qoi == 3) qoi->set_dims(sample_dims);
             // get current ratio
             double ratio = 0;
             {
                 size_t sampleOutSize;
-                memcpy(sampling_data, samples.data(), sampling_num * sizeof(T));
                 // reset variables for average of square
                 if(conf.qoi == 3) qoi->init();
-                auto cmprData = sz.compress(conf, sampling_data, sampleOutSize);
+                auto cmprData = sz.compress_from(conf, source, work.data(), sampleOutSize);
                 sz.clear();
                 delete[]cmprData;
                 ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;                
@@ -70,17 +79,19 @@ char *SZ_compress_Interp(SZ::Config &conf, T *data, size_t &outSize) {
             double current_ratio = ratio;
             double best_abs_eb = conf.absErrorBound;
             double best_ratio = current_ratio;
-            // check smaller bounds
-            while(true){
+            // check smaller bounds until the ratio drops. On small OpenMP tiles with isoline QoIs the ratio can stay
+            // flat while the bound shrinks, it would go down to ~1e-15 and the quantizer could not allocate its bins;
+            // the search stops at a bound 1e6 times smaller and keeps the best bound found
+            const int max_halvings = 20;
+            for(int halving = 0; halving < max_halvings; halving++){
                 auto prev_eb = conf.absErrorBound;
                 prev_ratio = current_ratio;
                 conf.absErrorBound /= 2;
                 qoi->set_global_eb(conf.absErrorBound);
                 size_t sampleOutSize;
-                memcpy(sampling_data, samples.data(), sampling_num * sizeof(T));
                 // reset variables for average of square
                 if(conf.qoi == 3) qoi->init();
-                auto cmprData = sz.compress(conf, sampling_data, sampleOutSize);
+                auto cmprData = sz.compress_from(conf, source, work.data(), sampleOutSize);
                 sz.clear();
                 delete[]cmprData;
                 current_ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;                
@@ -94,7 +105,6 @@ char *SZ_compress_Interp(SZ::Config &conf, T *data, size_t &outSize) {
                 }
             }
             // set error bound
-            free(sampling_data);
             //std::cout << "Best abs eb / pre-set eb: " << best_abs_eb / tmp_abs_eb << std::endl; 
             //std::cout << best_abs_eb << " " << tmp_abs_eb << std::endl;
             conf.absErrorBound = best_abs_eb;
@@ -112,7 +122,7 @@ char *SZ_compress_Interp(SZ::Config &conf, T *data, size_t &outSize) {
     auto sz = SZ::SZInterpolationCompressor<T, N, SZ::LinearQuantizer<T>, SZ::HuffmanEncoder<int>, SZ::Lossless_zstd>(
             SZ::LinearQuantizer<T>(conf.absErrorBound),
             SZ::HuffmanEncoder<int>(),
-            SZ::Lossless_zstd());
+            SZ::Lossless_zstd(conf.losslessLevel));
     char *cmpData = (char *) sz.compress(conf, data, outSize);
     return cmpData;
 }
@@ -170,7 +180,7 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
     assert(conf.cmprAlgo == SZ::ALGO_INTERP_LORENZO);
 
     //std::cout << "====================================== BEGIN TUNING ================================" << std::endl;
-    SZ::Timer timer(true);
+    SZ::ProfileScope tuning(SZ::STAGE_TUNING, conf.num * sizeof(T));
 
     SZ::calAbsErrorBound(conf, data);
     // overwrite qoi for parameter exploration
@@ -179,12 +189,9 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
     if(qoi){
         // compute abs qoi eb
         T qoi_rel_eb = conf.qoiEB;
-        T max = data[0];
-        T min = data[0];
-        for (size_t i = 1; i < conf.num; i++) {
-            if (max < data[i]) max = data[i];
-            if (min > data[i]) min = data[i];
-        }
+        const auto &stats = SZ::get_data_stats(conf, data);
+        T max = stats.max;
+        T min = stats.min;
         /*if(qoi == 1 || qoi == 3){
             // x^2
             auto max_2 = max * max;
@@ -266,12 +273,9 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
     }
     else{
         // compute isovalues for comparison
-        T max = data[0];
-        T min = data[0];
-        for (size_t i = 1; i < conf.num; i++) {
-            if (max < data[i]) max = data[i];
-            if (min > data[i]) min = data[i];
-        }
+        const auto &stats = SZ::get_data_stats(conf, data);
+        T max = stats.max;
+        T min = stats.min;
         conf.isovalues.clear();
         int num = conf.qoiIsoNum;
         auto range = max - min;
@@ -297,7 +301,9 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
     lorenzo_config.blockSize = 5;
     lorenzo_config.quantbinCnt = 65536 * 2;
     size_t sampleOutSize;
-    auto cmprData = SZ_compress_LorenzoReg<T, N>(lorenzo_config, sampling_data.data(), sampleOutSize);
+    // the Lorenzo trials overwrite their input with the reconstruction, each one runs on its own copy of the sample
+    std::vector<T> lorenzo_sample(sampling_data);
+    auto cmprData = SZ_compress_LorenzoReg<T, N>(lorenzo_config, lorenzo_sample.data(), sampleOutSize);
     delete[]cmprData;
     double ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;
 //    printf("Lorenzo ratio = %.2f\n", ratio);
@@ -336,8 +342,7 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
     if (false)  
     {
         conf.cmprAlgo = SZ::ALGO_INTERP;
-        double tuning_time = timer.stop();
-//        std::cout << "Tuning time = " << tuning_time << "s" << std::endl;
+        tuning.stop();
         //std::cout << "====================================== END TUNING ======================================" << std::endl;
         // assign qoi back
         conf.qoi = qoi;
@@ -349,7 +354,8 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
         if (N == 3) {
             lorenzo_config.quantbinCnt = SZ::optimize_quant_invl_3d<T>(data, conf.dims[0], conf.dims[1], conf.dims[2], conf.absErrorBound);
             lorenzo_config.pred_dim = 2;
-            cmprData = SZ_compress_LorenzoReg<T, N>(lorenzo_config, sampling_data.data(), sampleOutSize);
+            lorenzo_sample = sampling_data;
+            cmprData = SZ_compress_LorenzoReg<T, N>(lorenzo_config, lorenzo_sample.data(), sampleOutSize);
             delete[]cmprData;
             ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;
 //            printf("Lorenzo, pred_dim=2, ratio = %.2f\n", ratio);
@@ -363,7 +369,8 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
         if (conf.relErrorBound < 1.01e-6 && best_lorenzo_ratio > 5) {
             auto quant_num = lorenzo_config.quantbinCnt;
             lorenzo_config.quantbinCnt = 16384;
-            cmprData = SZ_compress_LorenzoReg<T, N>(lorenzo_config, sampling_data.data(), sampleOutSize);
+            lorenzo_sample = sampling_data;
+            cmprData = SZ_compress_LorenzoReg<T, N>(lorenzo_config, lorenzo_sample.data(), sampleOutSize);
             delete[]cmprData;
             ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;
 //            printf("Lorenzo, quant_bin=8192, ratio = %.2f\n", ratio);
@@ -400,8 +407,7 @@ char *SZ_compress_Interp_lorenzo(SZ::Config &conf, T *data, size_t &outSize) {
         conf = lorenzo_config;
         // assign qoi back
         conf.qoi = qoi;
-        double tuning_time = timer.stop();
-//        std::cout << "Tuning time = " << tuning_time << "s" << std::endl;
+        tuning.stop();
         // printf("lorenzo = %d, lorenzo2 = %d, block size = %d\n", conf.lorenzo, conf.lorenzo2, conf.blockSize);
         //std::cout << "====================================== END TUNING ======================================" << std::endl;
         return SZ_compress_LorenzoReg<T, N>(conf, data, outSize);
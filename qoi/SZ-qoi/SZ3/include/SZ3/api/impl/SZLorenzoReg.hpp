@@ -8,12 +8,14 @@
 #include "SZ3/quantizer/IntegerQuantizer.hpp"
 #include "SZ3/quantizer/QoIIntegerQuantizer.hpp"
 #include "SZ3/predictor/ComposedPredictor.hpp"
+#include "SZ3/predictor/StaticComposedPredictor.hpp"
 #include "SZ3/predictor/LorenzoPredictor.hpp"
 #include "SZ3/predictor/RegressionPredictor.hpp"
 #include "SZ3/predictor/PolyRegressionPredictor.hpp"
 #include "SZ3/encoder/QoIEncoder.hpp"
 #include "SZ3/qoi/XSquare.hpp"
 #include "SZ3/qoi/QoIInfo.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/lossless/Lossless_zstd.hpp"
 #include "SZ3/utils/Iterator.hpp"
 #include "SZ3/utils/Statistic.hpp"
@@ -22,8 +24,13 @@
 #include "SZ3/utils/Config.hpp"
 #include "SZ3/def.hpp"
 #include <cmath>
+#include <cstring>
 #include <memory>
 
+// first bytes of the data of the fast frontend in 1D, 2D and 4D; the general compressor, used for them before,
+// starts with the length of its lossless stage instead
+constexpr size_t SZ_LORENZO_REG_FAST = ~(size_t) 0;
+
 
 template<class T, SZ::uint N, class Quantizer, class Encoder, class Lossless>
 std::shared_ptr<SZ::concepts::CompressorInterface<T>>
@@ -36,6 +43,14 @@ make_lorenzo_regression_compressor(const SZ::Config &conf, Quantizer quantizer,
         printf("All lorenzo and regression methods are disabled.\n");
         exit(0);
     }
+    if (methodCnt == 2 && conf.lorenzo && conf.regression) {
+        // default setting, use the statically composed predictor to avoid virtual calls
+        return SZ::make_sz_general_compressor<T, N>(
+                SZ::make_sz_general_frontend<T, N>(conf, SZ::make_static_composed_predictor<T, N>(
+                        SZ::LorenzoPredictor<T, N, 1>(conf.absErrorBound),
+                        SZ::RegressionPredictor<T, N>(conf.blockSize, conf.absErrorBound)), quantizer),
+                encoder, lossless);
+    }
     if (conf.lorenzo) {
         if (use_single_predictor) {
             return SZ::make_sz_general_compressor<T, N>(
@@ -92,19 +107,18 @@ make_qoi_lorenzo_compressor(const SZ::Config &conf, std::shared_ptr<SZ::concepts
     if(use_single_predictor){
         if(conf.lorenzo){
             sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_qoi_frontend<T, N>(conf, SZ::LorenzoPredictor<T, N, 1>(conf.absErrorBound), quantizer, quantizer_eb, qoi),
-                                                    SZ::QoIEncoder<int>(), SZ::Lossless_zstd());
+                                                    SZ::QoIEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
         }
         else if(conf.lorenzo2){
             sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_qoi_frontend<T, N>(conf, SZ::LorenzoPredictor<T, N, 2>(conf.absErrorBound), quantizer, quantizer_eb, qoi),
-                                                    SZ::QoIEncoder<int>(), SZ::Lossless_zstd());
+                                                    SZ::QoIEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
         }
     }
     else{
-        std::vector<std::shared_ptr<SZ::concepts::PredictorInterface<T, N>>> predictors;
-        predictors.push_back(std::make_shared<SZ::LorenzoPredictor<T, N, 1>>(conf.absErrorBound));
-        predictors.push_back(std::make_shared<SZ::LorenzoPredictor<T, N, 2>>(conf.absErrorBound));
-        sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_qoi_frontend<T, N>(conf, SZ::ComposedPredictor<T, N>(predictors), quantizer, quantizer_eb, qoi),
-                                                SZ::QoIEncoder<int>(), SZ::Lossless_zstd());
+        auto predictor = SZ::make_static_composed_predictor<T, N>(SZ::LorenzoPredictor<T, N, 1>(conf.absErrorBound),
+                                                                  SZ::LorenzoPredictor<T, N, 2>(conf.absErrorBound));
+        sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_qoi_frontend<T, N>(conf, predictor, quantizer, quantizer_eb, qoi),
+                                                SZ::QoIEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
     }
     return sz;
 }
@@ -128,22 +142,25 @@ char *SZ_compress_LorenzoReg(SZ::Config &conf, T *data, size_t &outSize) {
         }
         // use sampling to determine abs bound
         {
+            SZ::ProfileScope tuning(SZ::STAGE_TUNING, conf.num * sizeof(T));
             auto dims = conf.dims;
             auto tmp_abs_eb = conf.absErrorBound;
 
-            size_t sampling_num, sampling_block;
-            std::vector<size_t> sample_dims(N);
-            std::vector<T> samples = SZ::sampling<T, N>(data, conf.dims, sampling_num, sample_dims, sampling_block);
+            // the trials compress the samples from source without modifying them, work holds their reconstruction
+            auto samples = SZ::make_sampling_view<T, N>(data, conf.dims);
+            size_t sampling_num = samples.sample_num;
+            std::vector<size_t> sample_dims = samples.sample_dims;
             conf.setDims(sample_dims.begin(), sample_dims.end());
 
             auto sz = make_qoi_lorenzo_compressor(conf, qoi, quantizer, quantizer_eb);
-            T * sampling_data = (T *) malloc(sampling_num * sizeof(T));
+            std::vector<T> gathered;
+            const T *source = SZ::sampling_source(samples, gathered);
+            std::vector<T> work(sampling_num);
             // get current ratio
             double ratio = 0;
             {
                 size_t sampleOutSize;
-                memcpy(sampling_data, samples.data(), sampling_num * sizeof(T));
-                auto cmprData = sz->compress(conf, sampling_data, sampleOutSize);
+                auto cmprData = sz->compress_from(conf, source, work.data(), sampleOutSize);
                 delete[]cmprData;
                 ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;                
                 std::cout << "current_eb = " << conf.absErrorBound << ", current_ratio = " << ratio << std::endl;
@@ -152,15 +169,17 @@ char *SZ_compress_LorenzoReg(SZ::Config &conf, T *data, size_t &outSize) {
             double current_ratio = ratio;
             double best_abs_eb = conf.absErrorBound;
             double best_ratio = current_ratio;
-            // check smaller bounds
-            while(true){
+            // check smaller bounds until the ratio drops. On small OpenMP tiles with isoline QoIs the ratio can stay
+            // flat while the bound shrinks, it would go down to ~1e-15 and the quantizer could not allocate its bins;
+            // the search stops at a bound 1e6 times smaller and keeps the best bound found
+            const int max_halvings = 20;
+            for(int halving = 0; halving < max_halvings; halving++){
                 auto prev_eb = conf.absErrorBound;
                 prev_ratio = current_ratio;
                 conf.absErrorBound /= 2;
                 qoi->set_global_eb(conf.absErrorBound);
                 size_t sampleOutSize;
-                memcpy(sampling_data, samples.data(), sampling_num * sizeof(T));
-                auto cmprData = sz->compress(conf, sampling_data, sampleOutSize);
+                auto cmprData = sz->compress_from(conf, source, work.data(), sampleOutSize);
                 delete[]cmprData;
                 current_ratio = sampling_num * 1.0 * sizeof(T) / sampleOutSize;                
                 std::cout << "current_eb = " << conf.absErrorBound << ", current_ratio = " << current_ratio << std::endl;
@@ -173,7 +192,6 @@ char *SZ_compress_LorenzoReg(SZ::Config &conf, T *data, size_t &outSize) {
                 }
             }
             // set error bound
-            free(sampling_data);
             //std::cout << "Best abs eb / pre-set eb: " << best_abs_eb / tmp_abs_eb << std::endl; 
             //std::cout << best_abs_eb << " " << tmp_abs_eb << std::endl;
             conf.absErrorBound = best_abs_eb;
@@ -185,13 +203,21 @@ char *SZ_compress_LorenzoReg(SZ::Config &conf, T *data, size_t &outSize) {
         return cmpData;
     }
     auto quantizer = SZ::LinearQuantizer<T>(conf.absErrorBound, conf.quantbinCnt / 2);
-    if (N == 3 && !conf.regression2) {
-        // use fast version for 3D
+    if (!conf.regression2) {
+        // use fast version
         auto sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_fast_frontend<T, N>(conf, quantizer), SZ::HuffmanEncoder<int>(),
-                                                       SZ::Lossless_zstd());
+                                                       SZ::Lossless_zstd(conf.losslessLevel));
         cmpData = (char *) sz->compress(conf, data, outSize);
+        if (N != 3) {
+            char *tagged = new char[sizeof(size_t) + outSize];
+            memcpy(tagged, &SZ_LORENZO_REG_FAST, sizeof(size_t));
+            memcpy(tagged + sizeof(size_t), cmpData, outSize);
+            delete[] cmpData;
+            cmpData = tagged;
+            outSize += sizeof(size_t);
+        }
     } else {
-        auto sz = make_lorenzo_regression_compressor<T, N>(conf, quantizer, SZ::HuffmanEncoder<int>(), SZ::Lossless_zstd());
+        auto sz = make_lorenzo_regression_compressor<T, N>(conf, quantizer, SZ::HuffmanEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
         cmpData = (char *) sz->compress(conf, data, outSize);
     }
     return cmpData;
@@ -224,18 +250,23 @@ void SZ_decompress_LorenzoReg(const SZ::Config &conf, char *cmpData, size_t cmpS
             }
         }
         else{
-            std::vector<std::shared_ptr<SZ::concepts::PredictorInterface<T, N>>> predictors;
-            predictors.push_back(std::make_shared<SZ::LorenzoPredictor<T, N, 1>>(conf.absErrorBound));
-            predictors.push_back(std::make_shared<SZ::LorenzoPredictor<T, N, 2>>(conf.absErrorBound));
-            sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_qoi_frontend<T, N>(conf, SZ::ComposedPredictor<T, N>(predictors), quantizer, quantizer_eb, qoi),
+            auto predictor = SZ::make_static_composed_predictor<T, N>(SZ::LorenzoPredictor<T, N, 1>(conf.absErrorBound),
+                                                                      SZ::LorenzoPredictor<T, N, 2>(conf.absErrorBound));
+            sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_qoi_frontend<T, N>(conf, predictor, quantizer, quantizer_eb, qoi),
                                                     SZ::QoIEncoder<int>(), SZ::Lossless_zstd());
         }
         sz->decompress(cmpDataPos, cmpSize, decData);
         return;
     }    
     SZ::LinearQuantizer<T> quantizer;
-    if (N == 3 && !conf.regression2) {
-        // use fast version for 3D
+    bool fast = N == 3 && !conf.regression2;
+    if (N != 3 && cmpSize >= sizeof(size_t) && memcmp(cmpDataPos, &SZ_LORENZO_REG_FAST, sizeof(size_t)) == 0) {
+        fast = true;
+        cmpDataPos += sizeof(size_t);
+        cmpSize -= sizeof(size_t);
+    }
+    if (fast) {
+        // use fast version
         auto sz = SZ::make_sz_general_compressor<T, N>(SZ::make_sz_fast_frontend<T, N>(conf, quantizer),
                                                        SZ::HuffmanEncoder<int>(), SZ::Lossless_zstd());
         sz->decompress(cmpDataPos, cmpSize, decData);
@@ -0,0 +1,147 @@
+#ifndef SZ3_IMPL_SZRATIO_HPP
+#define SZ3_IMPL_SZRATIO_HPP
+
+/**
+ * EB_RATIO: find the absolute error bound that gives conf.targetRatio.
+ * The ratio is estimated by compressing the sampled sub-field used for tuning (see SZ3/utils/Extraction.hpp)
+ * with the configured algorithm. The search brackets the target by steps of 10x in the error bound, then
+ * interpolates log(ratio) against log(eb) inside the bracket until the estimate is within conf.ratioTolerance.
+ */
+
+#include "SZ3/api/impl/SZDispatcher.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/Extraction.hpp"
+#include "SZ3/utils/Statistic.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// compression ratio of the sample at error bound eb
+template<class T, SZ::uint N>
+double SZ_ratio_estimate(const SZ::Config &conf, const std::vector<T> &sample, const std::vector<size_t> &sample_dims,
+                         const std::vector<T> &prev, double eb) {
+    SZ::Config trial = conf;
+    trial.setDims(sample_dims.begin(), sample_dims.end());
+    trial.errorBoundMode = SZ::EB_ABS;
+    trial.absErrorBound = eb;
+    trial.openmp = false;
+    trial.dataStats = SZ::DataStats();
+    trial.temporal.data = prev.empty() ? nullptr : prev.data();
+    trial.temporal.num = prev.size();
+    std::vector<T> buffer(sample);
+    size_t cmpSize = 0;
+    char *cmpData = SZ_compress_dispatcher<T, N>(trial, buffer.data(), cmpSize);
+    delete[] cmpData;
+    return sample.size() * sizeof(T) * 1.0 / std::max<size_t>(1, cmpSize);
+}
+
+/*
+ * resolve EB_RATIO into EB_ABS on data
+ * returns the slope of log(ratio) against log(eb) around the result, used to correct the bound afterwards
+ */
+template<class T, SZ::uint N>
+double SZ_ratio_search(SZ::Config &conf, const T *data) {
+    if (conf.targetRatio <= 1) {
+        printf("Error, EB_RATIO needs a target ratio above 1\n");
+        exit(0);
+    }
+    double range = SZ::get_data_stats(conf, data).range;
+    if (!(range > 0)) {
+        range = 1;
+    }
+
+    auto view = SZ::make_sampling_view<T, N>(data, conf.dims);
+    std::vector<T> sample(view.sample_num), prev;
+    SZ::sampling_gather(view, sample.data());
+    if (conf.temporal.data && conf.temporal.num == conf.num) {
+        auto prev_view = view;
+        prev_view.data = (const T *) conf.temporal.data;
+        prev.resize(view.sample_num);
+        SZ::sampling_gather(prev_view, prev.data());
+    }
+
+    // search in log space, x = log(eb) and y = log(ratio), which are close to linear
+    const double y_target = std::log(conf.targetRatio);
+    const double tol = std::max(1e-3, conf.ratioTolerance);
+    const double x_min = std::log(range * 1e-9), x_max = std::log(range);
+    auto estimate = [&](double x) {
+        return std::log(SZ_ratio_estimate<T, N>(conf, sample, view.sample_dims, prev, std::exp(x)));
+    };
+    auto within = [&](double y) { return std::fabs(std::exp(y - y_target) - 1) <= tol; };
+
+    double xa = std::log(range * 1e-3), ya = estimate(xa);
+    double xb = xa, yb = ya;
+    double slope = 1;
+    double x_best = xa;
+    if (!within(ya)) {
+        // bracket the target, [xa, xb] with ya < y_target < yb
+        double step = ya < y_target ? std::log(10.0) : -std::log(10.0);
+        while ((ya < y_target) == (yb < y_target)) {
+            double x = xb + step;
+            if (x > x_max || x < x_min) {
+                break;
+            }
+            xa = xb;
+            ya = yb;
+            xb = x;
+            yb = estimate(xb);
+        }
+        if (xa > xb) {
+            std::swap(xa, xb);
+            std::swap(ya, yb);
+        }
+        if (xa != xb && yb != ya) {
+            slope = (yb - ya) / (xb - xa);
+        }
+        if (!(ya < y_target && y_target < yb)) {
+            // out of reach, take the end closest to the target
+            x_best = std::fabs(ya - y_target) < std::fabs(yb - y_target) ? xa : xb;
+            printf("Warning, compression ratio %.2f is out of reach, using %.2f\n", conf.targetRatio,
+                   std::exp(x_best == xa ? ya : yb));
+        } else {
+            // prefer the end above the target, so that the output does not exceed its budget
+            x_best = xb;
+            for (int iter = 0; iter < 16 && !within(yb) && xb - xa > 1e-3; iter++) {
+                double x = xa + (y_target - ya) * (xb - xa) / (yb - ya);
+                x = std::min(std::max(x, xa + 0.1 * (xb - xa)), xb - 0.1 * (xb - xa));
+                double y = estimate(x);
+                if (y < y_target) {
+                    xa = x;
+                    ya = y;
+                } else {
+                    xb = x;
+                    yb = y;
+                }
+                if (within(y)) {
+                    xb = x;
+                    yb = y;
+                    break;
+                }
+            }
+            if (yb != ya) {
+                slope = (yb - ya) / (xb - xa);
+            }
+            x_best = xb;
+        }
+    }
+
+    conf.errorBoundMode = SZ::EB_ABS;
+    conf.absErrorBound = std::exp(x_best);
+    return std::max(slope, 0.1);
+}
+
+// resolve EB_RATIO for a field of any dimension
+template<class T>
+double SZ_ratio_search(SZ::Config &conf, const T *data) {
+    if (conf.N == 1) {
+        return SZ_ratio_search<T, 1>(conf, data);
+    } else if (conf.N == 2) {
+        return SZ_ratio_search<T, 2>(conf, data);
+    } else if (conf.N == 3) {
+        return SZ_ratio_search<T, 3>(conf, data);
+    } else {
+        return SZ_ratio_search<T, 4>(conf, data);
+    }
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef SZ3_SZ_TEMPORAL_HPP
+#define SZ3_SZ_TEMPORAL_HPP
+
+#include "SZ3/compressor/SZGeneralCompressor.hpp"
+#include "SZ3/frontend/SZGeneralFrontend.hpp"
+#include "SZ3/quantizer/IntegerQuantizer.hpp"
+#include "SZ3/predictor/StaticComposedPredictor.hpp"
+#include "SZ3/predictor/LorenzoPredictor.hpp"
+#include "SZ3/predictor/RegressionPredictor.hpp"
+#include "SZ3/predictor/TemporalPredictor.hpp"
+#include "SZ3/encoder/HuffmanEncoder.hpp"
+#include "SZ3/lossless/Lossless_zstd.hpp"
+#include "SZ3/api/impl/SZLorenzoReg.hpp"
+#include "SZ3/utils/Statistic.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/def.hpp"
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace SZ {
+
+    /**
+     * Keeps the reconstructed field of the previous timestep between calls of the temporal API, see sz.hpp.
+     * Use one context for the compression and one for the decompression of a sequence of steps;
+     * the decompression context must see the same steps in the same order as the compression context.
+     */
+    template<class T>
+    class TemporalContext {
+    public:
+        // keyframeInterval > 0: every keyframeInterval-th step is compressed without the previous step
+        explicit TemporalContext(size_t keyframeInterval = 0) : keyframeInterval(keyframeInterval) {}
+
+        // the next step will be a key frame
+        void reset() {
+            recon.clear();
+            dims.clear();
+            steps = 0;
+        }
+
+        // index of the next step
+        size_t step() const { return steps; }
+
+        // reconstructed field of the last step, empty before the first step
+        const std::vector<T> &previous() const { return recon; }
+
+        // reference to the previous step if it can be used for a field of the given dimensions
+        TemporalRef ref(const std::vector<size_t> &dims_) const {
+            TemporalRef r;
+            r.step = steps;
+            if (!recon.empty() && dims_ == dims && !(keyframeInterval && steps % keyframeInterval == 0)) {
+                r.data = recon.data();
+                r.num = recon.size();
+            }
+            return r;
+        }
+
+        // record the reconstruction of the current step
+        void commit(const std::vector<size_t> &dims_, size_t step, std::vector<T> &field) {
+            recon.swap(field);
+            dims = dims_;
+            steps = step + 1;
+        }
+
+        size_t keyframeInterval;
+
+    private:
+        std::vector<T> recon;
+        std::vector<size_t> dims;
+        size_t steps = 0;
+    };
+}
+
+// spatial lorenzo and regression plus the two temporal predictors, selected block by block
+template<class T, SZ::uint N>
+std::shared_ptr<SZ::concepts::CompressorInterface<T>> make_temporal_compressor(const SZ::Config &conf, const T *prev) {
+    return SZ::make_sz_general_compressor<T, N>(
+            SZ::make_sz_general_frontend<T, N>(conf, SZ::make_static_composed_predictor<T, N>(
+                    SZ::LorenzoPredictor<T, N, 1>(conf.absErrorBound),
+                    SZ::RegressionPredictor<T, N>(conf.blockSize, conf.absErrorBound),
+                    SZ::TemporalPredictor<T, N, 0>(prev, conf.absErrorBound),
+                    SZ::TemporalPredictor<T, N, 1>(prev, conf.absErrorBound)),
+                                               SZ::LinearQuantizer<T>(conf.absErrorBound, conf.quantbinCnt / 2)),
+            SZ::HuffmanEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
+}
+
+/*
+ * The compressed data of ALGO_TEMPORAL start with a key frame flag and the step index.
+ * Key frames are compressed like ALGO_LORENZO_REG, the other steps also predict from conf.temporal.
+ * data are overwritten by the reconstructed field, which becomes the previous step of the next call.
+ */
+template<class T, SZ::uint N>
+char *SZ_compress_Temporal(SZ::Config &conf, T *data, size_t &outSize) {
+
+    assert(N == conf.N);
+    assert(conf.cmprAlgo == SZ::ALGO_TEMPORAL);
+    SZ::calAbsErrorBound(conf, data);
+
+    if (conf.qoi > 0) {
+        printf("QoI is not supported by ALGO_TEMPORAL\n");
+        exit(0);
+    }
+    const T *prev = (const T *) conf.temporal.data;
+    uint8_t keyframe = (prev == nullptr);
+
+    size_t cmpSize = 0;
+    SZ::uchar *cmpData;
+    if (keyframe) {
+        auto sz = make_lorenzo_regression_compressor<T, N>(conf, SZ::LinearQuantizer<T>(conf.absErrorBound, conf.quantbinCnt / 2),
+                                                           SZ::HuffmanEncoder<int>(), SZ::Lossless_zstd(conf.losslessLevel));
+        cmpData = sz->compress(conf, data, cmpSize);
+    } else {
+        cmpData = make_temporal_compressor<T, N>(conf, prev)->compress(conf, data, cmpSize);
+    }
+
+    outSize = sizeof(uint8_t) + sizeof(size_t) + cmpSize;
+    auto out = new SZ::uchar[outSize];
+    SZ::uchar *pos = out;
+    SZ::write(keyframe, pos);
+    SZ::write(conf.temporal.step, pos);
+    memcpy(pos, cmpData, cmpSize);
+    delete[] cmpData;
+    return (char *) out;
+}
+
+
+template<class T, SZ::uint N>
+void SZ_decompress_Temporal(const SZ::Config &conf, char *cmpData, size_t cmpSize, T *decData) {
+    assert(conf.cmprAlgo == SZ::ALGO_TEMPORAL);
+
+    SZ::uchar const *cmpDataPos = (SZ::uchar *) cmpData;
+    uint8_t keyframe;
+    size_t step;
+    SZ::read(keyframe, cmpDataPos);
+    SZ::read(step, cmpDataPos);
+    cmpSize -= sizeof(uint8_t) + sizeof(size_t);
+
+    if (keyframe) {
+        auto sz = make_lorenzo_regression_compressor<T, N>(conf, SZ::LinearQuantizer<T>(), SZ::HuffmanEncoder<int>(),
+                                                           SZ::Lossless_zstd());
+        sz->decompress(cmpDataPos, cmpSize, decData);
+        return;
+    }
+    if (conf.temporal.data == nullptr || conf.temporal.step != step) {
+        printf("Error, step %zu of ALGO_TEMPORAL needs the reconstructed step %zu in the TemporalContext\n", step, step - 1);
+        exit(0);
+    }
+    make_temporal_compressor<T, N>(conf, (const T *) conf.temporal.data)->decompress(cmpDataPos, cmpSize, decData);
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 
 #include "SZ3/api/impl/SZImpl.hpp"
+#include "SZ3/api/impl/SZBatch.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/version.hpp"
 #include <memory>
 
@@ -13,6 +15,8 @@
  * @param data source data
  * @param outSize compressed data size in bytes
  * @return compressed data, remember to 'delete []' when the data is no longer needed.
+ * The compressed data are an indexed container (see SZ3/utils/Container.hpp): a header with the config and
+ * a table of independently compressed chunks, each protected by an xxhash64 checksum.
 
 The compression algorithms are:
 ALGO_INTERP_LORENZO:
@@ -24,6 +28,17 @@ ALGO_LORENZO_REG:
  The whole dataset will be compressed by lorenzo and/or regression based predictors block by block with default settings.
  The four predictors ( 1st-order lorenzo, 2nd-order lorenzo, 1st-order regression, 2nd-order regression)
  can be enabled or disabled independently by conf settings (lorenzo, lorenzo2, regression, regression2).
+ALGO_LORENZO_DUALQUANT:
+ The whole dataset will be compressed by 1st-order lorenzo on prequantized data (dual-quantization, as in cuSZ).
+ Every point is predicted independently, so this mode is parallelized with OpenMP and vectorized.
+ It is faster than ALGO_LORENZO_REG with a lower compression ratio, and does not support QoI.
+ALGO_TEMPORAL:
+ Timesteps of a simulation are compressed block by block with lorenzo, regression, or prediction from the
+ reconstructed previous step (its value, or temporal lorenzo). Used by the API with SZ::TemporalContext below.
+ALGO_WAVELET:
+ The whole dataset will be transformed with a multi-level CDF 9/7 wavelet, and the coefficients quantized and encoded.
+ The residual of every point is quantized as well, so the error bound holds as in the other algorithms.
+ It gives higher compression ratios on smooth fields, at about half the speed of ALGO_LORENZO_REG, and does not support QoI.
 
 Interpolation+lorenzo example:
 SZ::Config conf(100, 200, 300); // 300 is the fastest dimension
@@ -49,10 +64,25 @@ conf.regression2 = false;
 conf.errorBoundMode = SZ::EB_ABS; // refer to def.hpp for all supported error bound mode
 conf.absErrorBound = 1E-3; // absolute error bound 1e-3
 char *compressedData = SZ_compress(conf, data, outSize);
+
+Target ratio example:
+SZ::Config conf(100, 200, 300); // 300 is the fastest dimension
+conf.errorBoundMode = SZ::EB_RATIO; // the absolute error bound is searched on a sample of the data
+conf.targetRatio = 20; // outSize is about 1/20 of the input, within conf.ratioTolerance (5%)
+conf.ratioCorrection = false; // faster, but the ratio is only estimated on the sample
+char *compressedData = SZ_compress(conf, data, outSize); // conf.absErrorBound is the bound that was used
+
+Automatic axis order example:
+SZ::Config conf(26, 1800, 3600);
+conf.autoAxes = true; // the field may be compressed as e.g. 1800 x 3600 x 26, conf.axes tells the order used
+char *compressedData = SZ_compress(conf, data, outSize); // decompression gives 26 x 1800 x 3600 again
  */
 template<class T>
 char *SZ_compress(SZ::Config &conf, T *data, size_t &outSize) {
     char *cmpData;
+    // data statistics are only reused within one call, the buffer may hold a different field next time
+    conf.dataStats = SZ::DataStats();
+    conf.axes.clear();
     if (conf.N == 1) {
         cmpData = SZ_compress_impl<T, 1>(conf, data, outSize);
     } else if (conf.N == 2) {
@@ -69,17 +99,101 @@ char *SZ_compress(SZ::Config &conf, T *data, size_t &outSize) {
         conf.N = 4;
         cmpData = SZ_compress_impl<T, 4>(conf, data, outSize);
     }
-    {
-        //save config
-        SZ::uchar *cmpDataPos = (SZ::uchar *) cmpData + outSize;
-        conf.save(cmpDataPos);
-        size_t newSize = (char *) cmpDataPos - cmpData;
-        SZ::write(int(newSize - outSize), cmpDataPos);
-        outSize = (char *) cmpDataPos - cmpData;
+    return cmpData;
+}
+
+/**
+ * API for compression with a per-stage profile
+ * Same as SZ_compress(SZ::Config &conf, T *data, size_t &outSize), and also returns the time, calls and bytes
+ * of every stage (sampling, tuning, prediction, histogram, huffman, lossless, config), see SZ3/utils/Profiler.hpp.
+ * Stages run by other threads during the call, e.g. by a concurrent SZ_compress, are counted as well.
+
+ example:
+ SZ::Profile profile;
+ char *compressedData = SZ_compress(conf, data, outSize, profile);
+ printf("huffman time = %f\n", profile[SZ::STAGE_HUFFMAN].time);
+ */
+template<class T>
+char *SZ_compress(SZ::Config &conf, T *data, size_t &outSize, SZ::Profile &profile) {
+    auto begin = SZ::profile_snapshot();
+    char *cmpData = SZ_compress<T>(conf, data, outSize);
+    profile = SZ::profile_snapshot() - begin;
+    return cmpData;
+}
+
+/**
+ * API for compression that keeps data
+ * Same as SZ_compress(SZ::Config &conf, T *data, size_t &outSize), with the same output, but data are read-only:
+ * the library compresses a scratch copy instead, so callers do not need their own.
+ * conf.preserveTileElements > 0 limits the copy to tiles of that size per thread, which lowers the compression ratio
+ * slightly as every tile is stored as a chunk.
+
+ example:
+ const float *data = ...;
+ char *compressedData = SZ_compress(conf, data, outSize);
+ */
+template<class T>
+char *SZ_compress(SZ::Config &conf, const T *data, size_t &outSize) {
+    char *cmpData;
+    conf.dataStats = SZ::DataStats();
+    conf.axes.clear();
+    if (conf.N > 4) {
+        for (int i = 4; i < conf.N; i++) {
+            conf.dims[3] *= conf.dims[i];
+        }
+        conf.dims.resize(4);
+        conf.N = 4;
+    }
+    if (conf.N == 1) {
+        cmpData = SZ_compress_preserve_impl<T, 1>(conf, data, outSize);
+    } else if (conf.N == 2) {
+        cmpData = SZ_compress_preserve_impl<T, 2>(conf, data, outSize);
+    } else if (conf.N == 3) {
+        cmpData = SZ_compress_preserve_impl<T, 3>(conf, data, outSize);
+    } else {
+        cmpData = SZ_compress_preserve_impl<T, 4>(conf, data, outSize);
     }
     return cmpData;
 }
 
+// same as SZ_compress(SZ::Config &conf, T *data, size_t &outSize, SZ::Profile &profile) for read-only data
+template<class T>
+char *SZ_compress(SZ::Config &conf, const T *data, size_t &outSize, SZ::Profile &profile) {
+    auto begin = SZ::profile_snapshot();
+    char *cmpData = SZ_compress<T>(conf, data, outSize);
+    profile = SZ::profile_snapshot() - begin;
+    return cmpData;
+}
+
+/**
+ * API for compression of a sequence of timesteps
+ * Compresses data with ALGO_TEMPORAL, which chooses block by block between spatial (lorenzo, regression) and
+ * temporal prediction from the reconstructed previous step kept in context. data are not modified.
+ * The first step, a step with different dimensions, and every context.keyframeInterval-th step are key frames.
+ * The steps must be decompressed in the same order with another context, see SZ_decompress with TemporalContext.
+
+ example:
+ SZ::TemporalContext<float> context;
+ for (int step = 0; step < steps; step++) {
+     SZ::Config conf(100, 200, 300);
+     conf.errorBoundMode = SZ::EB_ABS;
+     conf.absErrorBound = 1E-3;
+     char *compressedData = SZ_compress(conf, data[step], outSize, context);
+ }
+ */
+template<class T>
+char *SZ_compress(SZ::Config &conf, T *data, size_t &outSize, SZ::TemporalContext<T> &context) {
+    // the frontend overwrites the field with its reconstruction, which is kept for the next step
+    std::vector<T> field(data, data + conf.num);
+    auto dims = conf.dims;
+    conf.cmprAlgo = SZ::ALGO_TEMPORAL;
+    conf.temporal = context.ref(dims);
+    char *cmpData = SZ_compress<T>(conf, field.data(), outSize);
+    context.commit(dims, conf.temporal.step, field);
+    conf.temporal = SZ::TemporalRef();
+    return cmpData;
+}
+
 
 /**
  * API for decompression
@@ -100,8 +214,26 @@ char *SZ_compress(SZ::Config &conf, T *data, size_t &outSize) {
  */
 template<class T>
 void SZ_decompress(SZ::Config &conf, char *cmpData, size_t cmpSize, T *&decData) {
+    if (SZ::container_check(cmpData, cmpSize)) {
+        std::vector<SZ::ContainerChunk> chunks;
+        size_t header_size = SZ::container_read(cmpData, cmpSize, conf, chunks);
+        if (decData == nullptr) {
+            decData = new T[conf.num];
+        }
+        char *payload = cmpData + header_size;
+        if (conf.N == 1) {
+            SZ_decompress_field<T, 1>(conf, chunks, payload, decData);
+        } else if (conf.N == 2) {
+            SZ_decompress_field<T, 2>(conf, chunks, payload, decData);
+        } else if (conf.N == 3) {
+            SZ_decompress_field<T, 3>(conf, chunks, payload, decData);
+        } else {
+            SZ_decompress_field<T, 4>(conf, chunks, payload, decData);
+        }
+        return;
+    }
     {
-        //load config
+        //load config of the legacy format, saved at the end of the data
         int confSize;
         memcpy(&confSize, cmpData + (cmpSize - sizeof(int)), sizeof(int));
         SZ::uchar const *cmpDataPos = (SZ::uchar *) cmpData + (cmpSize - sizeof(int) - confSize);
@@ -143,4 +275,100 @@ T *SZ_decompress(SZ::Config &conf, char *cmpData, size_t cmpSize) {
     return decData;
 }
 
+/**
+ * API for decompression with a per-stage profile
+ * Same as SZ_decompress(SZ::Config &conf, char *cmpData, size_t cmpSize, T *&decData),
+ * and also returns the profile of the stages, see SZ_compress with profile.
+ */
+template<class T>
+void SZ_decompress(SZ::Config &conf, char *cmpData, size_t cmpSize, T *&decData, SZ::Profile &profile) {
+    auto begin = SZ::profile_snapshot();
+    SZ_decompress<T>(conf, cmpData, cmpSize, decData);
+    profile = SZ::profile_snapshot() - begin;
+}
+
+/**
+ * API for decompression of a sequence of timesteps compressed by SZ_compress with TemporalContext
+ * context provides the previous step and keeps the decompressed step for the next call.
+ * Key frames can be decompressed with any context; the other steps need the previous step in context.
+ */
+template<class T>
+void SZ_decompress(SZ::Config &conf, char *cmpData, size_t cmpSize, T *&decData, SZ::TemporalContext<T> &context) {
+    auto &prev = context.previous();
+    conf.temporal = SZ::TemporalRef();
+    conf.temporal.data = prev.empty() ? nullptr : prev.data();
+    conf.temporal.num = prev.size();
+    conf.temporal.step = context.step();
+    SZ_decompress<T>(conf, cmpData, cmpSize, decData);
+    conf.temporal = SZ::TemporalRef();
+    if (conf.cmprAlgo != SZ::ALGO_TEMPORAL) {
+        printf("Error, the data were not compressed with ALGO_TEMPORAL\n");
+        exit(0);
+    }
+    // the step index is stored at the start of every chunk
+    auto chunk = cmpData;
+    if (SZ::container_check(cmpData, cmpSize)) {
+        std::vector<SZ::ContainerChunk> chunks;
+        SZ::Config c;
+        chunk = cmpData + SZ::container_read(cmpData, cmpSize, c, chunks) + chunks[0].offset + chunks[0].confSize;
+    }
+    size_t step;
+    memcpy(&step, chunk + sizeof(uint8_t), sizeof(size_t));
+    std::vector<T> field(decData, decData + conf.num);
+    context.commit(conf.dims, step, field);
+}
+
+/**
+ * API for compression of many fields in one call
+ * Fields may differ in data type, dimensions and settings. They are cut into slabs by estimated cost and
+ * compressed on one OpenMP thread team (OMP_NUM_THREADS), so many small fields keep all cores busy.
+ * Like SZ_compress, the field data are overwritten and the configs are updated (e.g. absErrorBound).
+ * ALGO_TEMPORAL fields are compressed as key frames, a previous step in conf.temporal is rejected.
+ * @param fields fields to compress, see SZ::FieldDesc
+ * @param outSize compressed size in bytes
+ * @return one stream with an index of the fields, remember to 'delete []' when the data is no longer needed.
+
+ example:
+ std::vector<SZ::FieldDesc> fields;
+ SZ::Config conf_t(100, 500, 500), conf_p(26, 1800, 3600);
+ fields.emplace_back("temperature", conf_t, temperature); // float *temperature
+ fields.emplace_back("pressure", conf_p, pressure);       // double *pressure
+ char *compressedData = SZ_compress_batch(fields, outSize);
+ */
+inline char *SZ_compress_batch(std::vector<SZ::FieldDesc> &fields, size_t &outSize) {
+    return SZ_compress_batch_impl(fields, outSize);
+}
+
+/**
+ * API for decompression of all the fields compressed by SZ_compress_batch
+ * The slabs of all fields are decompressed on one OpenMP thread team.
+ * @return the fields with their configs, call free_data() on each field when the data are no longer needed.
+ */
+inline std::vector<SZ::FieldDesc> SZ_decompress_batch(char *cmpData, size_t cmpSize) {
+    return SZ_decompress_batch_impl(cmpData, cmpSize);
+}
+
+/**
+ * API for decompression of one field compressed by SZ_compress_batch, the other fields are not read
+ * @param name name of the field
+ * @param decData pre-allocated memory space for the field, or nullptr to allocate it
+ */
+template<class T>
+void SZ_decompress_batch(char *cmpData, size_t cmpSize, const std::string &name, SZ::Config &conf, T *&decData) {
+    std::vector<SZ::BatchEntry> entries;
+    char *payload = cmpData + SZ::batch_read(cmpData, cmpSize, entries);
+    for (const auto &e: entries) {
+        if (e.name == name) {
+            if (e.type != SZ::data_type<T>::value) {
+                printf("Error, field %s has a different data type\n", name.c_str());
+                exit(0);
+            }
+            SZ_decompress<T>(conf, payload + e.offset, e.size, decData);
+            return;
+        }
+    }
+    printf("Error, field %s is not in the compressed data\n", name.c_str());
+    exit(0);
+}
+
 #endif
\ No newline at end of file
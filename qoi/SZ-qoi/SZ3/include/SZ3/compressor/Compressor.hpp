@@ -3,6 +3,7 @@
 
 #include "SZ3/def.hpp"
 #include "SZ3/utils/Config.hpp"
+#include <algorithm>
 
 namespace SZ {
     namespace concepts {
@@ -14,6 +15,12 @@ namespace SZ {
             virtual T *decompress(uchar const *cmpData, const size_t &cmpSize, T *decData) = 0;
 
             virtual uchar *compress(const Config &conf, T *data, size_t &compressed_size) = 0;
+
+            // compress source without modifying it, the reconstruction goes to work (conf.num elements)
+            virtual uchar *compress_from(const Config &conf, const T *source, T *work, size_t &compressed_size) {
+                std::copy_n(source, conf.num, work);
+                return compress(conf, work, compressed_size);
+            }
         };
     }
 }
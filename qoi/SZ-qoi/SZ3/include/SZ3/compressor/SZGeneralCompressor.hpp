@@ -7,6 +7,7 @@
 #include "SZ3/lossless/Lossless.hpp"
 #include "SZ3/utils/FileUtil.hpp"
 #include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/utils/Timer.hpp"
 #include "SZ3/def.hpp"
 #include <cstring>
@@ -28,10 +29,15 @@ namespace SZ {
         }
 
         uchar *compress(const Config &conf, T *data, size_t &compressed_size) {
+            return compress_from(conf, nullptr, data, compressed_size);
+        }
+
+        uchar *compress_from(const Config &conf, const T *source, T *work, size_t &compressed_size) {
 
-            Timer timer(true);
-            std::vector<int> quant_inds = frontend.compress(data);
-//            timer.stop("Prediction & Quantization");
+            ProfileScope prediction(STAGE_PREDICTION, conf.num * sizeof(T));
+            std::vector<int> quant_inds = source ? frontend.compress_from(source, work, conf.num) : frontend.compress(work);
+            prediction.add_bytes_out(quant_inds.size() * sizeof(int));
+            prediction.stop();
 
             size_t bufferSize = 1.5 * (frontend.size_est());
             uchar *buffer = new uchar[bufferSize];
@@ -39,19 +45,19 @@ namespace SZ {
 
             frontend.save(buffer_pos);
 
-            timer.start();
-            encoder.preprocess_encode(quant_inds, 0);
+            ProfileScope coding(STAGE_HUFFMAN, quant_inds.size() * sizeof(int));
+            uchar *coding_pos = buffer_pos;
+            encoder.preprocess_encode(quant_inds, frontend.get_histogram());
             encoder.save(buffer_pos);
             encoder.encode(quant_inds, buffer_pos);
             encoder.postprocess_encode();
-//            timer.stop("Coding");
+            coding.add_bytes_out(buffer_pos - coding_pos);
+            coding.stop();
             assert(buffer_pos - buffer < bufferSize);
 
             frontend.clear();
-            timer.start();
             uchar *lossless_data = lossless.compress(buffer, buffer_pos - buffer, compressed_size);
             lossless.postcompress_data(buffer);
-//            timer.stop("Lossless");
 
             return lossless_data;
         }
@@ -64,25 +70,23 @@ namespace SZ {
         T *decompress(uchar const *cmpData, const size_t &cmpSize, T *decData) {
             size_t remaining_length = cmpSize;
 
-            // Timer timer(true);
             auto compressed_data = lossless.decompress(cmpData, remaining_length);
             uchar const *compressed_data_pos = compressed_data;
-//            timer.stop("Lossless");
 
             frontend.load(compressed_data_pos, remaining_length);
 
+            ProfileScope coding(STAGE_HUFFMAN, remaining_length);
             encoder.load(compressed_data_pos, remaining_length);
-
-            // timer.start();
             auto quant_inds = encoder.decode(compressed_data_pos, frontend.get_num_elements());
             encoder.postprocess_decode();
-//            timer.stop("Decoder");
+            coding.add_bytes_out(quant_inds.size() * sizeof(int));
+            coding.stop();
 
             lossless.postdecompress_data(compressed_data);
 
-            // timer.start();
+            ProfileScope prediction(STAGE_PREDICTION, quant_inds.size() * sizeof(int));
             frontend.decompress(quant_inds, decData);
-//            timer.stop("Prediction & Recover");
+            prediction.add_bytes_out(frontend.get_num_elements() * sizeof(T));
             return decData;
         }
 
@@ -11,6 +11,7 @@
 #include "SZ3/utils/Config.hpp"
 #include "SZ3/utils/FileUtil.hpp"
 #include "SZ3/utils/Interpolators.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/utils/Timer.hpp"
 #include "SZ3/def.hpp"
 #include "SZ3/utils/Config.hpp"
@@ -52,14 +53,20 @@ namespace SZ {
             init();
 
             quantizer.load(buffer_pos, remaining_length);
+            ProfileScope coding(STAGE_HUFFMAN, remaining_length);
             encoder.load(buffer_pos, remaining_length);
             quant_inds = encoder.decode(buffer_pos, num_elements);
 
             encoder.postprocess_decode();
+            coding.add_bytes_out(quant_inds.size() * sizeof(int));
+            coding.stop();
 
             lossless.postdecompress_data(buffer);
             double eb = quantizer.get_eb();
 
+            ProfileScope prediction(STAGE_PREDICTION, quant_inds.size() * sizeof(int));
+            prediction.add_bytes_out(num_elements * sizeof(T));
+
             *decData = quantizer.recover(0, quant_inds[quant_index++]);
 
             for (uint level = interpolation_level; level > 0 && level <= interpolation_level; level--) {
@@ -109,11 +116,10 @@ namespace SZ {
             double eb = quantizer.get_eb();
 //            printf("Absolute error bound = %.5f\n", eb);
 
+            ProfileScope prediction(STAGE_PREDICTION, num_elements * sizeof(T));
+            quantizer.precompress_data();
             quant_inds.push_back(quantizer.quantize_and_overwrite(*data, 0));
 
-            Timer timer;
-            timer.start();
-
             for (uint level = interpolation_level; level > 0 && level <= interpolation_level; level--) {
                 if (level >= 3) {
                     quantizer.set_eb(eb * eb_ratio);
@@ -147,7 +153,8 @@ namespace SZ {
 //            std::cout << "Number of data point = " << num_elements << std::endl;
 //            std::cout << "quantization element = " << quant_inds.size() << std::endl;
             assert(quant_inds.size() == num_elements);
-//            timer.stop("Prediction & Quantization");
+            prediction.add_bytes_out(quant_inds.size() * sizeof(int));
+            prediction.stop();
 
 //            writefile("pred.dat", preds.data(), num_elements);
 //            writefile("quant.dat", quant_inds.data(), num_elements);
@@ -164,20 +171,20 @@ namespace SZ {
             quantizer.postcompress_data();
 
 
-            timer.start();
-            encoder.preprocess_encode(quant_inds, 0);
+            ProfileScope coding(STAGE_HUFFMAN, quant_inds.size() * sizeof(int));
+            uchar *coding_pos = buffer_pos;
+            encoder.preprocess_encode(quant_inds, quantizer.get_histogram());
             encoder.save(buffer_pos);
             encoder.encode(quant_inds, buffer_pos);
             encoder.postprocess_encode();
-//            timer.stop("Coding");
+            coding.add_bytes_out(buffer_pos - coding_pos);
+            coding.stop();
             assert(buffer_pos - buffer < bufferSize);
 
-            timer.start();
             uchar *lossless_data = lossless.compress(buffer,
                                                      buffer_pos - buffer,
                                                      compressed_size);
             lossless.postcompress_data(buffer);
-//            timer.stop("Lossless");
 
             compressed_size += interp_compressed_size;
             return lossless_data;
@@ -12,6 +12,7 @@
 #include "SZ3/utils/Config.hpp"
 #include "SZ3/utils/FileUtil.hpp"
 #include "SZ3/utils/Interpolators.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/utils/Timer.hpp"
 #include "SZ3/def.hpp"
 #include "SZ3/utils/Config.hpp"
@@ -61,14 +62,19 @@ namespace SZ {
             quantizer_eb.load(buffer_pos, remaining_length);
             quantizer.load(buffer_pos, remaining_length);
             // std::cout << "load encoder, offset = " << buffer_pos - buffer << std::endl;
+            ProfileScope coding(STAGE_HUFFMAN, remaining_length);
             encoder.load(buffer_pos, remaining_length);
             quant_inds = encoder.decode(buffer_pos, num_elements);
 
             encoder.postprocess_decode();
+            coding.add_bytes_out(quant_inds.size() * sizeof(int));
+            coding.stop();
             // std::cout << "after encoder, offset = " << buffer_pos - buffer << std::endl;
 
             lossless.postdecompress_data(buffer);
             // timer.stop("Decoding");
+            ProfileScope prediction(STAGE_PREDICTION, quant_inds.size() * sizeof(int));
+            prediction.add_bytes_out(num_elements * sizeof(T));
             // double eb = qoi->get_global_eb();
 
             // std::cout << "start with first data\n";
@@ -132,6 +138,7 @@ namespace SZ {
 //            printf("Absolute error bound = %.5f\n", eb);
 
             // quant_inds.push_back(quantizer.quantize_and_overwrite(*data, 0));
+            ProfileScope prediction(STAGE_PREDICTION, num_elements * sizeof(T));
             quantize_data(0, data, 0);
 
             // Timer timer;
@@ -172,7 +179,8 @@ namespace SZ {
 //            std::cout << "Number of data point = " << num_elements << std::endl;
 //            std::cout << "quantization element = " << quant_inds.size() << std::endl;
             // assert(quant_inds.size() == num_elements);
-            // timer.stop("Prediction & Quantization");
+            prediction.add_bytes_out(quant_inds.size() * sizeof(int));
+            prediction.stop();
             // timer.start();
 //            writefile("pred.dat", preds.data(), num_elements);
 //            writefile("quant.dat", quant_inds.data(), num_elements);
@@ -194,10 +202,14 @@ namespace SZ {
 
             // timer.start();
             // std::cout << "save encoder, offset = " << buffer_pos - buffer << std::endl;
+            ProfileScope coding(STAGE_HUFFMAN, quant_inds.size() * sizeof(int));
+            uchar *coding_pos = buffer_pos;
             encoder.preprocess_encode(quant_inds, 0);
             encoder.save(buffer_pos);
             encoder.encode(quant_inds, buffer_pos);
             encoder.postprocess_encode();
+            coding.add_bytes_out(buffer_pos - coding_pos);
+            coding.stop();
             // std::cout << "after encoder, offset = " << buffer_pos - buffer << std::endl;
             // timer.stop("Encoding");
             // timer.start();
@@ -214,6 +226,14 @@ namespace SZ {
             return lossless_data;
         }
 
+        // compress source without modifying it, every point is copied to work when it is quantized
+        uchar *compress_from(const Config &conf, const T *source, T *work, size_t &compressed_size) {
+            this->source = source;
+            uchar *lossless_data = compress(conf, work, compressed_size);
+            this->source = nullptr;
+            return lossless_data;
+        }
+
         void clear() {
             quantizer.clear();
             quantizer_eb.clear();
@@ -222,6 +242,9 @@ namespace SZ {
     private:
 
         inline void quantize_data(size_t offset, T * data, T pred){
+            if (source) {
+                *data = source[offset];
+            }
             auto ori_data = *data;
             auto eb = qoi->interpret_eb(data, offset);
             quant_inds[quant_index] = quantizer_eb.quantize_and_overwrite(eb);
@@ -559,6 +582,7 @@ namespace SZ {
         std::array<size_t, N> dimension_offsets;
         std::vector<std::array<int, N>> dimension_sequences;
         int direction_sequence_id;
+        const T *source = nullptr; // compress_from() only
     };
 
 
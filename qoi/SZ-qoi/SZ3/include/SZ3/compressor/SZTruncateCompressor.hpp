@@ -13,14 +13,21 @@
 #include "SZ3/def.hpp"
 #include <cstring>
 
+/**
+ * Keeps the top byteLen bytes of every value and compresses them with the lossless stage. By default the kept bytes
+ * are shuffled into byte planes (see truncateArrayShuffle), which is faster and compresses better than interleaved
+ * bytes; shuffle = false writes the interleaved layout of older streams (float only). The layout is recorded in one
+ * byte ahead of the lossless payload, so decompression does not depend on shuffle.
+ */
+
 namespace SZ {
     template<class T, uint N, class Lossless>
     class SZTruncateCompressor : public concepts::CompressorInterface<T> {
     public:
 
 
-        SZTruncateCompressor(const Config &conf, Lossless lossless, int byteLens) :
-                lossless(lossless), conf(conf), byteLen(byteLens) {
+        SZTruncateCompressor(const Config &conf, Lossless lossless, int byteLens, bool shuffle = true) :
+                lossless(lossless), conf(conf), byteLen(byteLens), shuffle(shuffle) {
             static_assert(std::is_base_of<concepts::LosslessInterface, Lossless>::value,
                           "must implement the lossless interface");
         }
@@ -31,14 +38,26 @@ namespace SZ {
             auto compressed_data_pos = (uchar *) compressed_data;
 
             Timer timer(true);
-            truncateArray(data, conf.num, byteLen, compressed_data_pos);
+            if (shuffle) {
+                truncateArrayShuffle(data, conf.num, byteLen, compressed_data_pos);
+            } else {
+                truncateArray(data, conf.num, byteLen, compressed_data_pos);
+            }
             timer.stop("Prediction & Quantization");
 
+            size_t lossless_size = 0;
             uchar *lossless_data = lossless.compress(compressed_data,
                                                      (uchar *) compressed_data_pos - compressed_data,
-                                                     compressed_size);
+                                                     lossless_size);
             lossless.postcompress_data(compressed_data);
-            return lossless_data;
+
+            compressed_size = sizeof(uint8_t) + lossless_size;
+            auto out = new uchar[compressed_size];
+            uchar *out_pos = out;
+            write((uint8_t) shuffle, out_pos);
+            memcpy(out_pos, lossless_data, lossless_size);
+            delete[] lossless_data;
+            return out;
         }
 
         T *decompress(uchar const *cmpData, const size_t &cmpSize, size_t num) {
@@ -48,13 +67,19 @@ namespace SZ {
 
         T *decompress(uchar const *cmpData, const size_t& cmpSize, T *decData) {
             size_t remaining_length = cmpSize;
+            uint8_t shuffled;
+            read(shuffled, cmpData, remaining_length);
 
             auto compressed_data = lossless.decompress(cmpData, remaining_length);
             auto compressed_data_pos = (uchar *) compressed_data;
 
             Timer timer(true);
 //            auto dec_data = new T[conf.num];
-            truncateArrayRecover(compressed_data_pos, conf.num, byteLen, decData);
+            if (shuffled) {
+                truncateArrayShuffleRecover(compressed_data_pos, conf.num, byteLen, decData);
+            } else {
+                truncateArrayRecover(compressed_data_pos, conf.num, byteLen, decData);
+            }
 
             lossless.postdecompress_data(compressed_data);
             timer.stop("Prediction & Recover");
@@ -67,12 +92,13 @@ namespace SZ {
         Lossless lossless;
         Config conf;
         int byteLen = 2;
+        bool shuffle = true;
     };
 
     template<class T, uint N, class Lossless>
     SZTruncateCompressor<T, N, Lossless>
-    make_sz_truncate_compressor(const Config &conf, Lossless lossless, int byteLens) {
-        return SZTruncateCompressor<T, N, Lossless>(conf, lossless, byteLens);
+    make_sz_truncate_compressor(const Config &conf, Lossless lossless, int byteLens, bool shuffle = true) {
+        return SZTruncateCompressor<T, N, Lossless>(conf, lossless, byteLens, shuffle);
     }
 }
 #endif
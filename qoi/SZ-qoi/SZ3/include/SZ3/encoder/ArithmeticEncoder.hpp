@@ -59,6 +59,11 @@ namespace SZ {
         void postprocess_decode() {};
 
 
+        // the dense histogram covers all quantization bins, so its size is the number of states
+        void preprocess_encode(const std::vector<T> &bins, const std::vector<size_t> &histogram) {
+            preprocess_encode(bins, (int) histogram.size());
+        }
+
         void preprocess_encode(const std::vector<T> &bins, int stateNum) {
             assert(stateNum <= 4096 && "StateNum of Arithmetic Encoder should be <= 4096");
             ariCoder.numOfRealStates = stateNum;
@@ -17,6 +17,10 @@ namespace SZ {
             assert(stateNum <= 256 && "stateNum should be no more than 256.");
         };
 
+        void preprocess_encode(const std::vector<T> &bins, const std::vector<size_t> &histogram) {
+            preprocess_encode(bins, 0);
+        };
+
         size_t encode(const std::vector<T> &bins, uchar *&bytes) {
             for (auto &bin: bins) {
                 *bytes++ = uchar(bin);
@@ -12,6 +12,12 @@ namespace SZ {
 
             virtual void preprocess_encode(const std::vector<T> &bins, int stateNum) = 0;
 
+            /**
+             * same as preprocess_encode(bins, stateNum), with the symbol histogram collected during quantization
+             * @param histogram histogram[i] is the number of occurrences of symbol i in bins, empty if not available
+             */
+            virtual void preprocess_encode(const std::vector<T> &bins, const std::vector<size_t> &histogram) = 0;
+
             virtual size_t encode(const std::vector<T> &bins, uchar *&bytes) = 0;
 
             virtual void postprocess_encode() = 0;
@@ -5,6 +5,7 @@
 #include "SZ3/encoder/Encoder.hpp"
 #include "SZ3/utils/ByteUtil.hpp"
 #include "SZ3/utils/MemoryUtil.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/utils/Timer.hpp"
 #include "SZ3/utils/ska_hash/unordered_map.hpp"
 #include <cassert>
@@ -16,6 +17,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
+#include <numeric>
 
 
 namespace SZ {
@@ -107,6 +109,23 @@ namespace SZ {
             nodeCount = nodeCount * 2 - 1;
         }
 
+        /**
+         * build huffman tree using the histogram of bins, so bins are not scanned again
+         * @param bins
+         * @param histogram histogram[i] is the frequency of symbol i, falls back to scanning bins if it does not match
+         */
+        void preprocess_encode(const std::vector<T> &bins, const std::vector<size_t> &histogram) {
+            if (histogram.empty() || std::accumulate(histogram.begin(), histogram.end(), (size_t) 0) != bins.size()) {
+                preprocess_encode(bins, 0);
+                return;
+            }
+            nodeCount = 0;
+            init(histogram.data(), histogram.size(), 0);
+            for (int i = 0; i < huffmanTree->stateNum; i++)
+                if (huffmanTree->code[i]) nodeCount++;
+            nodeCount = nodeCount * 2 - 1;
+        }
+
         //save the huffman Tree in the compressed data
         uint save(uchar *&c) {
             write(offset, c);
@@ -514,31 +533,58 @@ namespace SZ {
          * */
         void init(const T *s, size_t length) {
             if (length == 0) {
+                init(nullptr, 0, 0);
                 return;
             }
             T max = s[0];
-            offset = s[0]; //offset is min
-
-            ska::unordered_map<T, size_t> frequency;
-            for (size_t i = 0; i < length; i++) {
-                frequency[s[i]]++;
-            }
+            T min = s[0];
+            std::vector<size_t> histogram;
+            {
+                ProfileScope scope(STAGE_HISTOGRAM, length * sizeof(T));
+                ska::unordered_map<T, size_t> frequency;
+                for (size_t i = 0; i < length; i++) {
+                    frequency[s[i]]++;
+                }
 
-            for (const auto &kv: frequency) {
-                auto k=kv.first;
-                if (k > max) {
-                    max = k;
+                for (const auto &kv: frequency) {
+                    auto k = kv.first;
+                    if (k > max) {
+                        max = k;
+                    }
+                    if (k < min) {
+                        min = k;
+                    }
                 }
-                if (k < offset) {
-                    offset = k;
+
+                histogram.assign(max - min + 1, 0);
+                for (const auto &f: frequency) {
+                    histogram[f.first - min] = f.second;
                 }
             }
+            init(histogram.data(), histogram.size(), min);
+        }
 
-            int stateNum = max - offset + 2;
+        // build the tree from a dense histogram, histogram[i] is the frequency of symbol (i + min)
+        void init(const size_t *histogram, size_t histogram_size, T min) {
+            size_t first = 0, last = histogram_size;
+            while (first < last && histogram[first] == 0) first++;
+            while (last > first && histogram[last - 1] == 0) last--;
+            // without any symbol, the tree of the single symbol min keeps save(), encode() and decode() valid
+            bool empty = first == last;
+            if (empty) {
+                first = 0;
+                last = 1;
+            }
+            offset = min + (T) first;
+
+            int stateNum = last - first + 1;
             huffmanTree = createHuffmanTree(stateNum);
 
-            for (const auto &f: frequency) {
-                qinsert(new_node(f.second, f.first - offset, 0, 0));
+            // symbols are inserted in increasing order, so the tree only depends on the frequencies
+            for (size_t i = first; i < last; i++) {
+                if (empty || histogram[i]) {
+                    qinsert(new_node(empty ? 1 : histogram[i], (T) (i - first), 0, 0));
+                }
             }
 
             while (huffmanTree->qend > 2)
@@ -44,6 +44,11 @@ namespace SZ {
             data_encoder.preprocess_encode(bins.data() + num_elements, num_elements, stateNum);
         }
 
+        // the histogram of the combined eb/data bins does not help the two separate trees
+        void preprocess_encode(const std::vector<T> &bins, const std::vector<size_t> &histogram) {
+            preprocess_encode(bins, 0);
+        }
+
         //save the huffman Tree in the compressed data
         uint save(uchar *&c) {
             auto s1 = eb_encoder.save(c);
@@ -17,6 +17,10 @@ namespace SZ {
         void preprocess_encode(const std::vector<T> &bins, int stateNum) {
         };
 
+        void preprocess_encode(const std::vector<T> &bins, const std::vector<size_t> &histogram) {
+            preprocess_encode(bins, 0);
+        };
+
         size_t encode(const std::vector<T> &bins, uchar *&bytes) {
             int max = 0;
             size_t s = 0;
@@ -7,6 +7,7 @@
  */
 
 #include "SZ3/def.hpp"
+#include <algorithm>
 #include <vector>
 
 namespace SZ {
@@ -22,6 +23,12 @@ namespace SZ {
 
             virtual std::vector<int> compress(T *data) = 0;
 
+            // same as compress(work) on a copy of the num elements of source, source is not modified
+            virtual std::vector<int> compress_from(const T *source, T *work, size_t num) {
+                std::copy_n(source, num, work);
+                return compress(work);
+            }
+
             virtual T *decompress(std::vector<int> &quant_inds, T *dec_data) = 0;
 
             virtual void save(uchar *&c) = 0;
@@ -34,6 +41,9 @@ namespace SZ {
 
             virtual size_t get_num_elements() const = 0;
 
+            // histogram of the quantization indices produced by the last compress(), empty if not collected
+            virtual const std::vector<size_t> &get_histogram() const = 0;
+
             virtual void print() = 0;
 
             virtual void clear() = 0;
@@ -0,0 +1,352 @@
+#ifndef SZ3_DUALQUANT_FRONTEND
+#define SZ3_DUALQUANT_FRONTEND
+/**
+ * This module is the CPU implementation of the dual-quantization Lorenzo scheme used by cuSZ.
+ * Data are prequantized to integers q = round(d / 2eb) first, so the Lorenzo prediction works on
+ * q instead of reconstructed values. The prediction error of every point only depends on the
+ * prequantized input, therefore all points can be processed in parallel (OpenMP + SIMD).
+ * Integer 1st-order Lorenzo in N-D is the composition of backward differences along each dimension,
+ * and its inverse is the composition of prefix sums.
+ */
+
+#include "Frontend.hpp"
+#include "SZ3/def.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/MemoryUtil.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace SZ {
+
+
+    template<class T, uint N>
+    class SZDualQuantFrontend : public concepts::FrontendInterface<T, N> {
+    public:
+
+        SZDualQuantFrontend(const Config &conf) :
+                error_bound(conf.absErrorBound),
+                radius(conf.quantbinCnt / 2),
+                num_elements(conf.num) {
+            std::copy_n(conf.dims.begin(), N, global_dimensions.begin());
+        }
+
+        ~SZDualQuantFrontend() = default;
+
+        std::vector<int> compress(T *data) {
+            init_strides();
+            std::vector<int64_t> delta(num_elements);
+            prequantize_and_diff(data, delta.data());
+            for (int d = (int) N - 2; d >= 0; d--) {
+                diff(delta.data(), d);
+            }
+
+            std::vector<int> quant_inds(num_elements);
+            quantize(delta.data(), quant_inds.data());
+            return quant_inds;
+        }
+
+        T *decompress(std::vector<int> &quant_inds, T *dec_data) {
+            init_strides();
+            std::vector<int64_t> delta(num_elements);
+            recover(quant_inds.data(), delta.data());
+            for (int d = 0; d < (int) N - 1; d++) {
+                prefix_sum(delta.data(), d);
+            }
+            prefix_sum_and_dequantize(delta.data(), dec_data);
+            return dec_data;
+        }
+
+        void save(uchar *&c) {
+            write(global_dimensions.data(), N, c);
+            write(error_bound, c);
+            write(radius, c);
+
+            write(outlier_index.size(), c);
+            write(outlier_index.data(), outlier_index.size(), c);
+            write(outlier_value.data(), outlier_value.size(), c);
+
+            write(verbatim_index.size(), c);
+            write(verbatim_index.data(), verbatim_index.size(), c);
+            write(verbatim_value.data(), verbatim_value.size(), c);
+        }
+
+        void load(const uchar *&c, size_t &remaining_length) {
+            clear();
+            read(global_dimensions.data(), N, c, remaining_length);
+            num_elements = 1;
+            for (const auto &d: global_dimensions) {
+                num_elements *= d;
+            }
+            read(error_bound, c, remaining_length);
+            read(radius, c, remaining_length);
+
+            size_t outlier_count;
+            read(outlier_count, c, remaining_length);
+            outlier_index.resize(outlier_count);
+            outlier_value.resize(outlier_count);
+            read(outlier_index.data(), outlier_count, c, remaining_length);
+            read(outlier_value.data(), outlier_count, c, remaining_length);
+
+            size_t verbatim_count;
+            read(verbatim_count, c, remaining_length);
+            verbatim_index.resize(verbatim_count);
+            verbatim_value.resize(verbatim_count);
+            read(verbatim_index.data(), verbatim_count, c, remaining_length);
+            read(verbatim_value.data(), verbatim_count, c, remaining_length);
+        }
+
+        size_t size_est() {
+            return sizeof(size_t) * N + sizeof(double) + sizeof(int) + 2 * sizeof(size_t)
+                   + outlier_index.size() * (sizeof(size_t) + sizeof(int64_t))
+                   + verbatim_index.size() * (sizeof(size_t) + sizeof(T))
+                   + sizeof(T) * num_elements;
+        }
+
+        void print() {}
+
+        void clear() {
+            outlier_index.clear();
+            outlier_value.clear();
+            verbatim_index.clear();
+            verbatim_value.clear();
+            histogram.clear();
+        }
+
+        int get_radius() const { return radius; }
+
+        size_t get_num_elements() const { return num_elements; };
+
+        const std::vector<size_t> &get_histogram() const { return histogram; }
+
+    private:
+
+        void init_strides() {
+            size_t stride = 1;
+            for (int d = N - 1; d >= 0; d--) {
+                dim_strides[d] = stride;
+                stride *= global_dimensions[d];
+            }
+        }
+
+        // prequantized value; points that can not be represented exactly are stored verbatim and use q = 0
+        inline int64_t prequantize(T data, double recip) const {
+            double q = std::round(data * recip);
+            return (std::fabs(q) < max_prequant) ? (int64_t) q : 0;
+        }
+
+        // prequantize and take the difference along the last (contiguous) dimension in one pass,
+        // then overwrite data by the reconstruction
+        void prequantize_and_diff(T *data, int64_t *delta) {
+            const size_t n = global_dimensions[N - 1];
+            const size_t rows = num_elements / n;
+            const double eb2 = 2 * error_bound;
+            const double recip = 1.0 / eb2;
+
+            std::vector<std::vector<size_t>> index_t(1);
+            std::vector<std::vector<T>> value_t(1);
+#pragma omp parallel
+            {
+                int tid = 0;
+#ifdef _OPENMP
+                tid = omp_get_thread_num();
+#pragma omp single
+                {
+                    index_t.resize(omp_get_num_threads());
+                    value_t.resize(omp_get_num_threads());
+                }
+#endif
+                // rows are split into segments so that 1D data are processed in parallel as well
+#pragma omp for collapse(2) schedule(static)
+                for (size_t r = 0; r < rows; r++) {
+                    for (size_t jb = 0; jb < n; jb += line_block) {
+                        const T *row = data + r * n;
+                        int64_t *out = delta + r * n;
+                        size_t jend = std::min(n, jb + line_block);
+                        size_t jstart = jb;
+                        if (jb == 0) {
+                            out[0] = prequantize(row[0], recip);
+                            jstart = 1;
+                        }
+#pragma omp simd
+                        for (size_t j = jstart; j < jend; j++) {
+                            out[j] = prequantize(row[j], recip) - prequantize(row[j - 1], recip);
+                        }
+                        // the cast to T may push the reconstruction out of bound, keep such points verbatim
+                        for (size_t j = jb; j < jend; j++) {
+                            T dec = (T) (prequantize(row[j], recip) * eb2);
+                            if (!(std::fabs(dec - row[j]) <= error_bound)) {
+                                index_t[tid].push_back(r * n + j);
+                                value_t[tid].push_back(row[j]);
+                            }
+                        }
+                    }
+                }
+                // all reads of data end at the barrier above; verbatim points are already exact
+#pragma omp for simd schedule(static)
+                for (size_t i = 0; i < num_elements; i++) {
+                    T dec = (T) (prequantize(data[i], recip) * eb2);
+                    if (std::fabs(dec - data[i]) <= error_bound) {
+                        data[i] = dec;
+                    }
+                }
+            }
+            // static schedule keeps the per-thread lists in index order
+            verbatim_index.clear();
+            verbatim_value.clear();
+            for (int t = 0; t < index_t.size(); t++) {
+                verbatim_index.insert(verbatim_index.end(), index_t[t].begin(), index_t[t].end());
+                verbatim_value.insert(verbatim_value.end(), value_t[t].begin(), value_t[t].end());
+            }
+        }
+
+        // backward difference along dimension d, in place
+        void diff(int64_t *x, int d) {
+            const size_t n = global_dimensions[d];
+            const size_t inner = dim_strides[d];
+            const size_t outer = num_elements / (n * inner);
+#pragma omp parallel for collapse(2) schedule(static)
+            for (size_t o = 0; o < outer; o++) {
+                for (size_t kb = 0; kb < inner; kb += line_block) {
+                    int64_t *base = x + o * n * inner;
+                    size_t kend = std::min(inner, kb + line_block);
+                    for (size_t j = n - 1; j >= 1; j--) {
+                        int64_t *cur = base + j * inner;
+                        const int64_t *prev = cur - inner;
+#pragma omp simd
+                        for (size_t k = kb; k < kend; k++) {
+                            cur[k] -= prev[k];
+                        }
+                    }
+                }
+            }
+        }
+
+        // inclusive prefix sum along dimension d, in place
+        void prefix_sum(int64_t *x, int d) {
+            const size_t n = global_dimensions[d];
+            const size_t inner = dim_strides[d];
+            const size_t outer = num_elements / (n * inner);
+#pragma omp parallel for collapse(2) schedule(static)
+            for (size_t o = 0; o < outer; o++) {
+                for (size_t kb = 0; kb < inner; kb += line_block) {
+                    int64_t *base = x + o * n * inner;
+                    size_t kend = std::min(inner, kb + line_block);
+                    for (size_t j = 1; j < n; j++) {
+                        int64_t *cur = base + j * inner;
+                        const int64_t *prev = cur - inner;
+#pragma omp simd
+                        for (size_t k = kb; k < kend; k++) {
+                            cur[k] += prev[k];
+                        }
+                    }
+                }
+            }
+        }
+
+        // prefix sum along the last dimension and dequantize in one pass
+        void prefix_sum_and_dequantize(const int64_t *delta, T *dec_data) {
+            const size_t n = global_dimensions[N - 1];
+            const size_t rows = num_elements / n;
+            const double eb2 = 2 * error_bound;
+#pragma omp parallel for schedule(static)
+            for (size_t r = 0; r < rows; r++) {
+                const int64_t *row = delta + r * n;
+                T *out = dec_data + r * n;
+                int64_t q = 0;
+                for (size_t j = 0; j < n; j++) {
+                    q += row[j];
+                    out[j] = (T) (q * eb2);
+                }
+            }
+#pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < verbatim_index.size(); i++) {
+                dec_data[verbatim_index[i]] = verbatim_value[i];
+            }
+        }
+
+        // map deltas to quantization indices and count them for the encoder in the same pass
+        void quantize(const int64_t *delta, int *quant_inds) {
+            std::vector<std::vector<size_t>> index_t(1);
+            std::vector<std::vector<int64_t>> value_t(1);
+            std::vector<std::vector<size_t>> histogram_t(1);
+#pragma omp parallel
+            {
+                int tid = 0;
+#ifdef _OPENMP
+                tid = omp_get_thread_num();
+#pragma omp single
+                {
+                    index_t.resize(omp_get_num_threads());
+                    value_t.resize(omp_get_num_threads());
+                    histogram_t.resize(omp_get_num_threads());
+                }
+#endif
+                auto &hist = histogram_t[tid];
+                hist.assign(2 * radius, 0);
+#pragma omp for schedule(static)
+                for (size_t i = 0; i < num_elements; i++) {
+                    int64_t v = delta[i];
+                    if (v > -radius && v < radius) {
+                        quant_inds[i] = (int) v + radius;
+                    } else {
+                        quant_inds[i] = 0;
+                        index_t[tid].push_back(i);
+                        value_t[tid].push_back(v);
+                    }
+                    hist[quant_inds[i]]++;
+                }
+            }
+            outlier_index.clear();
+            outlier_value.clear();
+            histogram.assign(2 * radius, 0);
+            for (int t = 0; t < index_t.size(); t++) {
+                outlier_index.insert(outlier_index.end(), index_t[t].begin(), index_t[t].end());
+                outlier_value.insert(outlier_value.end(), value_t[t].begin(), value_t[t].end());
+                for (size_t b = 0; b < histogram.size(); b++) {
+                    histogram[b] += histogram_t[t][b];
+                }
+            }
+        }
+
+        void recover(const int *quant_inds, int64_t *delta) {
+#pragma omp parallel for simd schedule(static)
+            for (size_t i = 0; i < num_elements; i++) {
+                delta[i] = (int64_t) quant_inds[i] - radius;
+            }
+#pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < outlier_index.size(); i++) {
+                delta[outlier_index[i]] = outlier_value[i];
+            }
+        }
+
+        // |q| has to stay below 2^52 so that q * 2eb and the prefix sums are exact
+        static constexpr double max_prequant = 4503599627370496.0;
+        static constexpr size_t line_block = 1024;
+
+        double error_bound;
+        int radius;
+        size_t num_elements;
+        std::array<size_t, N> global_dimensions;
+        std::array<size_t, N> dim_strides;
+        std::vector<size_t> outlier_index;
+        std::vector<int64_t> outlier_value;
+        std::vector<size_t> verbatim_index;
+        std::vector<T> verbatim_value;
+        std::vector<size_t> histogram;
+    };
+
+    template<class T, uint N>
+    SZDualQuantFrontend<T, N>
+    make_sz_dualquant_frontend(const Config &conf) {
+        return SZDualQuantFrontend<T, N>(conf);
+    }
+}
+
+#endif
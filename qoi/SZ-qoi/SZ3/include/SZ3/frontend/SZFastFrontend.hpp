@@ -4,7 +4,10 @@
 /**
  * This module is the implementation of the prediction and quantization methods in SZ2.
  * It has better speed than SZFrontend since multidimensional iterator is not used.
- * Currently only 3D data is supported.
+ * Data in 1D to 4D are compressed as a 3D view, see set_view().
+ * The slabs of blocks along the first dimension of the view are split into groups that are compressed independently,
+ * each from zero padding and with its own stream of regression coefficients, so that the groups are compressed and
+ * decompressed in parallel with OpenMP. There is one group without OpenMP or inside a parallel region.
  */
 
 #include "Frontend.hpp"
@@ -14,7 +17,13 @@
 #include "SZ3/encoder/HuffmanEncoder.hpp"
 #include "SZ3/utils/MemoryUtil.hpp"
 #include "SZ3/utils/Config.hpp"
+#include <algorithm>
 #include <list>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace SZ {
     using namespace SZMETA;
@@ -22,13 +31,24 @@ namespace SZ {
     template<class T, uint N, class Quantizer>
     class SZFastFrontend : public concepts::FrontendInterface<T, N> {
     public:
+        // first int of the data since the groups, the data before them start with the block size
+        static constexpr int GROUPED = -1;
+        // groups smaller than this lose too much compression ratio to their boundaries
+        static constexpr size_t MIN_GROUP_ELEMENTS = 1 << 16;
+        // dimensions of the view that are not 1, see set_view()
+        static constexpr int RANK = N < 3 ? N : 3;
+
         SZFastFrontend(const Config &conf, Quantizer quantizer) :
                 quantizer(quantizer),
                 params(false, conf.blockSize, conf.pred_dim, 0, conf.lorenzo, conf.lorenzo2,
                        conf.regression, conf.absErrorBound),
                 precision(conf.absErrorBound),
                 conf(conf) {
-            assert(N == 3 && "SZMeta Front only support 3D data");
+#ifdef _OPENMP
+            if (conf.openmp) {
+                nThreads = conf.nThreads > 0 ? conf.nThreads : omp_get_max_threads();
+            }
+#endif
         }
 
         ~SZFastFrontend() {
@@ -48,36 +68,28 @@ namespace SZ {
 
 
         void save(uchar *&c) {
-
+            write(GROUPED, c);
             write(params, c);
             write(precision, c);
-//            write(intv_radius, c);
             write(mean_info, c);
-            write(reg_count, c);
-//            write(unpred_count_buffer, size.block_size * size.block_size, c);
-//            T *unpred_data_buffer_pos = unpred_data_buffer;
-//            for (int i = 0; i < size.block_size; i++) {
-//                for (int j = 0; j < size.block_size; j++) {
-//                    write(unpred_data_buffer_pos,
-//                          unpred_count_buffer[i * size.block_size + j], c);
-////                    write_array_to_dst(c, unpred_data_buffer_pos,
-////                                       unpred_count_buffer[i * size.block_size + j]);
-//                    unpred_data_buffer_pos += est_unpred_count_per_index;
-//                }
-//            }
-
-//            Huffman_encode_tree_and_data(SELECTOR_RADIUS, indicator, size.num_blocks, c);
+            write(groups.size(), c);
+            for (const auto &group: groups) {
+                write(group.reg_count, c);
+                write(group.unpred_count, c);
+            }
+
             HuffmanEncoder<int> selector_encoder = HuffmanEncoder<int>();
             selector_encoder.preprocess_encode(indicator, SELECTOR_RADIUS);
             selector_encoder.save(c);
             selector_encoder.encode(indicator, c);
             selector_encoder.postprocess_encode();
 
-//	convertIntArray2ByteArray_fast_1b_to_result_sz(indicator, size.num_blocks, c);
-
-            if (reg_count) {
-                encode_regression_coefficients(reg_params_type, reg_unpredictable_data, RegCoeffNum3d * reg_count,
-                                               reg_unpredictable_data_pos - reg_unpredictable_data, c);
+            for (const auto &group: groups) {
+                if (group.reg_count) {
+                    encode_regression_coefficients(group.reg_params_type.data(), group.reg_unpredictable_data.data(),
+                                                   RegCoeffNum3d * group.reg_count,
+                                                   group.reg_unpredictable_data.size(), c);
+                }
             }
 
             quantizer.save(c);
@@ -87,78 +99,69 @@ namespace SZ {
             clear();
             const uchar *c_pos = c;
 
-            read(params, c, remaining_length);
-            read(precision, c, remaining_length);
-//            read(intv_radius, c, remaining_length);
-            read(mean_info, c, remaining_length);
-            read(reg_count, c, remaining_length);
-
-            size_t r1 = conf.dims[0];
-            size_t r2 = conf.dims[1];
-            size_t r3 = conf.dims[2];
-            size = SZMETA::DSize_3d(r1, r2, r3, params.block_size);
-            // prepare unpred buffer for vectorization
-            est_unpred_count_per_index = size.num_blocks * size.block_size * 1;
-            // if(!params.block_independant) est_unpred_count_per_index /= 20;
-//            unpred_count_buffer = (int *) malloc(size.block_size * size.block_size * sizeof(T));
-//            read(unpred_count_buffer, size.block_size * size.block_size, c, remaining_length);
-//            unpred_data_buffer = (T *) malloc(
-//                    size.block_size * size.block_size * est_unpred_count_per_index * sizeof(T));
-//            T *unpred_data_buffer_pos = unpred_data_buffer;
-//            for (int i = 0; i < size.block_size; i++) {
-//                for (int j = 0; j < size.block_size; j++) {
-//                    memcpy(unpred_data_buffer_pos, c,
-//                           unpred_count_buffer[i * size.block_size + j] * sizeof(T));
-//                    c += unpred_count_buffer[i * size.block_size + j] * sizeof(T);
-//                    unpred_data_buffer_pos += est_unpred_count_per_index;
-//                }
-//            }
-//            memset(unpred_count_buffer, 0, size.block_size * size.block_size * sizeof(int));
-//	unsigned char * indicator = convertByteArray2IntArray_fast_1b_sz(size.num_blocks, c, (size.num_blocks - 1)/8 + 1);
+            int format = 0;
+            memcpy(&format, c, sizeof(int));
+            if (format == GROUPED) {
+                read(format, c, remaining_length);
+                read(params, c, remaining_length);
+                read(precision, c, remaining_length);
+                read(mean_info, c, remaining_length);
+                set_view();
+                size_t num_groups = 1;
+                read(num_groups, c, remaining_length);
+                set_groups(num_groups);
+                for (auto &group: groups) {
+                    read(group.reg_count, c, remaining_length);
+                    read(group.unpred_count, c, remaining_length);
+                }
+            } else {
+                // 3D data in a single group, the unpredictable data are counted once the quantizer is loaded
+                size_t reg_count = 0;
+                read(params, c, remaining_length);
+                read(precision, c, remaining_length);
+                read(mean_info, c, remaining_length);
+                read(reg_count, c, remaining_length);
+                set_view();
+                set_groups(1);
+                groups[0].reg_count = reg_count;
+            }
+
             HuffmanEncoder<int> selector_encoder = HuffmanEncoder<int>();
             selector_encoder.load(c, remaining_length);
             indicator = selector_encoder.decode(c, size.num_blocks);
             selector_encoder.postprocess_decode();
 
-
-            if (reg_count) {
-                reg_params = decode_regression_coefficients(c, reg_count, size.block_size, precision,
-                                                            params);
+            for (auto &group: groups) {
+                if (group.reg_count) {
+                    float *reg_params = decode_regression_coefficients(c, remaining_length, group.reg_count,
+                                                                       size.block_size, precision, params);
+                    group.reg_params.assign(reg_params, reg_params + RegCoeffNum3d * (group.reg_count + 1));
+                    free(reg_params);
+                }
             }
             quantizer.load(c, remaining_length);
+            if (format != GROUPED) {
+                groups[0].unpred_count = quantizer.get_unpred_count();
+            }
             remaining_length -= c_pos - c;
         }
 
 
         void clear() {
-            if (reg_params_type != nullptr) {
-                free(reg_params_type);
-                reg_params_type = nullptr;
-            }
-            if (reg_unpredictable_data != nullptr) {
-                free(reg_unpredictable_data);
-                reg_unpredictable_data = nullptr;
-            }
-//            if (unpred_data_buffer != nullptr) {
-//                free(unpred_data_buffer);
-//                unpred_data_buffer = nullptr;
-//            }
-//            if (unpred_count_buffer != nullptr) {
-//                free(unpred_count_buffer);
-//                unpred_count_buffer = nullptr;
-//            }
-            if (reg_params != nullptr) {
-                free(reg_params);
-                reg_params = nullptr;
-            }
+            groups.clear();
         }
 
         size_t size_est() {
+            size_t reg_size = 1024; // headers and Huffman trees
+            for (const auto &group: groups) {
+                reg_size += 2 * sizeof(size_t) // group header
+                            + RegCoeffNum3d * group.reg_count * sizeof(int) // reg coeff quant
+                            + group.reg_unpredictable_data.size() * sizeof(float); //reg coeff unpred
+            }
             return quantizer.size_est() //unpred
                    + sizeof(T) * size.num_elements//quantbin
                    + indicator.size() * sizeof(int) //loren or reg indicator
-                   + RegCoeffNum3d * reg_count * sizeof(int) // reg coeff quant
-                   + (reg_unpredictable_data_pos - reg_unpredictable_data) * sizeof(float); //reg coeff unpred
+                   + reg_size;
         }
 
         int get_radius() const {
@@ -168,55 +171,111 @@ namespace SZ {
 
         size_t get_num_elements() const { return size.num_elements; };
 
+        const std::vector<size_t> &get_histogram() const { return quantizer.get_histogram(); }
+
     private:
-        //        unsigned char *
-//        compress_3d(const T *data, size_t r1, size_t r2, size_t r3, double precision, size_t &compressed_size,
-//                    const SZMETA::meta_params &params, SZMETA::CompressStats &compress_info) {
-        std::vector<int> compress_3d(const T *data) {
-            clear();
+        // slabs of blocks [begin, end) along the first dimension of the view, compressed independently
+        struct Group {
+            size_t begin = 0;
+            size_t end = 0;
+            size_t reg_count = 0;
+            size_t unpred_count = 0; // unpredictable data of the group, stored in the quantizer after the previous groups
+            std::vector<int> reg_params_type;
+            std::vector<float> reg_unpredictable_data;
+            std::vector<float> reg_params; // decompression only
+        };
 
-            size_t r1 = conf.dims[0];
-            size_t r2 = conf.dims[1];
-            size_t r3 = conf.dims[2];
-            size = SZMETA::DSize_3d(r1, r2, r3, conf.blockSize);
-
-//            capacity = 0; // num of quant intervals
-//            mean_info = optimize_quant_invl_3d(data, r1, r2, r3, conf.absErrorBound, capacity);
-//            if (conf.quantbinCnt > 0) {
-//                capacity = conf.quantbinCnt;
-//            }
-//            intv_radius = (capacity >> 1);
-            std::vector<int> type(size.num_elements);
-//            int *type = (int *) malloc(size.num_elements * sizeof(int));
-//            indicator = (int *) malloc(size.num_blocks * sizeof(int));
+        /*
+         * 3D view of the data: 1D data are (n, 1, 1), 2D data are (n1, 1, n2), so that a slab of blocks stays small,
+         * and the two slowest dimensions of 4D data are merged. The padding layers of the prediction buffer are zero
+         * along the dimensions of 1, which turns the Lorenzo predictors of the view into the 1D and 2D ones.
+         */
+        void set_view() {
+            const auto &dims = conf.dims;
+            if (N == 1) {
+                size = SZMETA::DSize_3d(dims[0], 1, 1, params.block_size);
+            } else if (N == 2) {
+                size = SZMETA::DSize_3d(dims[0], 1, dims[1], params.block_size);
+            } else if (N == 3) {
+                size = SZMETA::DSize_3d(dims[0], dims[1], dims[2], params.block_size);
+            } else {
+                size = SZMETA::DSize_3d(dims[0] * dims[1], dims[2], dims[3], params.block_size);
+            }
+        }
+
+        void set_groups(size_t num_groups) {
+            groups.assign(num_groups, Group());
+            for (size_t g = 0; g < num_groups; g++) {
+                groups[g].begin = g * size.num_x / num_groups;
+                groups[g].end = (g + 1) * size.num_x / num_groups;
+            }
+        }
+
+        std::vector<int> compress_3d(T *data) {
+            clear();
+            set_view();
+            // 1st-order Lorenzo in 2D is 1D along the first dimension of the (n, 1, 1) view
+            params.prediction_dim = RANK < 2 ? 2 : std::min(params.prediction_dim, RANK);
+
+            size_t num_groups = 1;
+#ifdef _OPENMP
+            if (nThreads > 1 && !omp_in_parallel()) {
+                num_groups = std::min({(size_t) nThreads, size.num_x, size.num_elements / MIN_GROUP_ELEMENTS});
+                num_groups = std::max<size_t>(num_groups, 1);
+            }
+#endif
+            set_groups(num_groups);
             indicator.resize(size.num_blocks);
+            std::vector<int> type(size.num_elements);
 
-            reg_params_type = (int *) malloc(RegCoeffNum3d * size.num_blocks * sizeof(int));
-            reg_unpredictable_data = (float *) malloc(RegCoeffNum3d * size.num_blocks * sizeof(float));
-            reg_unpredictable_data_pos = reg_unpredictable_data;
-
-            // prepare unpred buffer for vectorization
-            est_unpred_count_per_index = size.num_blocks * size.block_size * 1;
-            // if(!params.block_independant) est_unpred_count_per_index /= 20;
-//            unpred_data_buffer = (T *) malloc(
-//                    size.block_size * size.block_size * est_unpred_count_per_index * sizeof(T));
-//            unpred_count_buffer = (int *) malloc(size.block_size * size.block_size * sizeof(int));
-//            memset(unpred_count_buffer, 0, size.block_size * size.block_size * sizeof(int));
-//        T precision_t = (T) precision;
-            reg_count = 0;
-            size_t lorenzo_count = 0;
-            size_t lorenzo_2layer_count = 0;
-
-            int *type_pos = type.data();
-            int *indicator_pos = indicator.data();
-
-            float *reg_params = (float *) malloc(RegCoeffNum3d * (size.num_blocks + 1) * sizeof(float));
-            for (int i = 0; i < RegCoeffNum3d; i++) {
-                reg_params[i] = 0;
+            quantizer.clear();
+            quantizer.precompress_data();
+            if (num_groups == 1) {
+                // no copy of the quantizer and its histogram, as inside the tiles of the OpenMP container
+                compress_group(data, type.data(), groups[0], quantizer);
+                groups[0].unpred_count = quantizer.get_unpred_count();
+                return type;
+            }
+            std::vector<Quantizer> quantizers(num_groups, quantizer);
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads) if(num_groups > 1)
+            for (ptrdiff_t g = 0; g < (ptrdiff_t) num_groups; g++) {
+                compress_group(data, type.data(), groups[g], quantizers[g]);
             }
-            float *reg_params_pos = reg_params + RegCoeffNum3d;
-            int *reg_params_type_pos = reg_params_type;
+            for (size_t g = 0; g < num_groups; g++) {
+                groups[g].unpred_count = quantizers[g].get_unpred_count();
+                quantizer.merge(quantizers[g]);
+            }
+            return type;
+        }
 
+        T *decompress_3d(std::vector<int> &quant_inds, T *dec_data) {
+            std::vector<size_t> unpred_begin(groups.size(), 0);
+            for (size_t g = 1; g < groups.size(); g++) {
+                unpred_begin[g] = unpred_begin[g - 1] + groups[g - 1].unpred_count;
+            }
+            const bool parallel = nThreads > 1 && groups.size() > 1;
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads) if(parallel)
+            for (ptrdiff_t g = 0; g < (ptrdiff_t) groups.size(); g++) {
+                Quantizer group_quantizer = quantizer.slice(unpred_begin[g], groups[g].unpred_count);
+                decompress_group(quant_inds.data(), dec_data, groups[g], group_quantizer);
+            }
+            return dec_data;
+        }
+
+        // the group starts from zero padding and zero regression coefficients, like the first slab
+        void compress_group(T *data, int *type, Group &group, Quantizer &quantizer) {
+            size_t num_blocks = (group.end - group.begin) * size.num_y * size.num_z;
+            size_t offset = group.begin * size.block_size * size.dim0_offset;
+            int *type_pos = type + offset;
+            int *indicator_pos = indicator.data() + group.begin * size.num_y * size.num_z;
+
+            group.reg_params_type.resize(RegCoeffNum3d * num_blocks);
+            group.reg_unpredictable_data.resize(RegCoeffNum3d * num_blocks);
+            float *reg_unpredictable_data_pos = group.reg_unpredictable_data.data();
+            std::vector<float> reg_params(RegCoeffNum3d * (num_blocks + 1), 0);
+            float *reg_params_pos = reg_params.data() + RegCoeffNum3d;
+            int *reg_params_type_pos = group.reg_params_type.data();
+            size_t reg_count = 0;
 
             T reg_precisions[RegCoeffNum3d];
             T reg_recip_precisions[RegCoeffNum3d];
@@ -232,21 +291,16 @@ namespace SZ {
             size_t buffer_dim0_offset =
                     (size.d2 + params.lorenzo_padding_layer) * (size.d3 + params.lorenzo_padding_layer);
             size_t buffer_dim1_offset = size.d3 + params.lorenzo_padding_layer;
-            T *pred_buffer = (T *) malloc(
-                    (size.block_size + params.lorenzo_padding_layer) * (size.d2 + params.lorenzo_padding_layer) *
-                    (size.d3 + params.lorenzo_padding_layer) * sizeof(T));
-            memset(pred_buffer, 0,
-                   (size.block_size + params.lorenzo_padding_layer) * (size.d2 + params.lorenzo_padding_layer) *
-                   (size.d3 + params.lorenzo_padding_layer) * sizeof(T));
+            std::vector<T> pred_buffer((size.block_size + params.lorenzo_padding_layer) * buffer_dim0_offset, 0);
             int capacity_lorenzo = mean_info.use_mean ? capacity - 2 : capacity;
             T recip_precision = (T) 1.0 / conf.absErrorBound;
 
-            const T *x_data_pos = data;
-            for (size_t i = 0; i < size.num_x; i++) {
-                const T *y_data_pos = x_data_pos;
-                T *pred_buffer_pos = pred_buffer;
+            T *x_data_pos = data + offset;
+            for (size_t i = group.begin; i < group.end; i++) {
+                T *y_data_pos = x_data_pos;
+                T *pred_buffer_pos = pred_buffer.data();
                 for (size_t j = 0; j < size.num_y; j++) {
-                    const T *z_data_pos = y_data_pos;
+                    T *z_data_pos = y_data_pos;
                     for (size_t k = 0; k < size.num_z; k++) {
                         int size_x = ((i + 1) * size.block_size < size.d1) ? size.block_size : size.d1 -
                                                                                                i * size.block_size;
@@ -254,11 +308,11 @@ namespace SZ {
                                                                                                j * size.block_size;
                         int size_z = ((k + 1) * size.block_size < size.d3) ? size.block_size : size.d3 -
                                                                                                k * size.block_size;
-                        int min_size = MIN(size_x, size_y);
-                        min_size = MIN(min_size, size_z);
+                        // the dimensions of 1 in the view do not count
+                        int min_size = RANK == 3 ? MIN(MIN(size_x, size_y), size_z) :
+                                       (RANK == 2 ? MIN(size_x, size_z) : size_x);
 
                         bool enable_regression = params.use_regression_linear && min_size >= 2;
-//                bool enable_regression = params.use_regression_linear && min_size >= 1;
 
                         if (enable_regression) {
                             compute_regression_coeffcients_3d(z_data_pos, size_x, size_y, size_z, size.dim0_offset,
@@ -269,7 +323,7 @@ namespace SZ {
                         int selection_result = meta_blockwise_selection_3d(z_data_pos, mean_info, size.dim0_offset,
                                                                            size.dim1_offset,
                                                                            min_size, conf.absErrorBound, reg_params_pos,
-                                                                           params.prediction_dim,
+                                                                           std::min(params.prediction_dim, RANK),
                                                                            params.use_lorenzo,
                                                                            params.use_lorenzo_2layer,
                                                                            enable_regression);
@@ -305,12 +359,6 @@ namespace SZ {
                                                            params.lorenzo_padding_layer,
                                                            (selection_result == SELECTOR_LORENZO_2LAYER), quantizer,
                                                            params.prediction_dim);
-//
-                            if (selection_result == SELECTOR_LORENZO_2LAYER) {
-                                lorenzo_2layer_count++;
-                            } else {
-                                lorenzo_count++;
-                            }
                         }
                         pred_buffer_pos += size.block_size;
                         indicator_pos++;
@@ -319,46 +367,42 @@ namespace SZ {
                     y_data_pos += size.block_size * size.dim1_offset;
                     pred_buffer_pos += size.block_size * buffer_dim1_offset - size.block_size * size.num_z;
                 }
+                // the data of the slab are replaced by their reconstruction, as in the other frontends;
+                // the block selection of the next slabs only reads the data of their own blocks
+                size_t slab_size = std::min((size_t) size.block_size, size.d1 - i * size.block_size);
+                for (size_t x = 0; x < slab_size; x++) {
+                    for (size_t y = 0; y < size.d2; y++) {
+                        memcpy(x_data_pos + x * size.dim0_offset + y * size.dim1_offset,
+                               pred_buffer.data() + (x + params.lorenzo_padding_layer) * buffer_dim0_offset +
+                               (y + params.lorenzo_padding_layer) * buffer_dim1_offset + params.lorenzo_padding_layer,
+                               size.d3 * sizeof(T));
+                    }
+                }
                 // copy bottom of buffer to top of buffer
-                memcpy(pred_buffer, pred_buffer + size.block_size * buffer_dim0_offset,
+                memcpy(pred_buffer.data(), pred_buffer.data() + size.block_size * buffer_dim0_offset,
                        params.lorenzo_padding_layer * buffer_dim0_offset * sizeof(T));
                 x_data_pos += size.block_size * size.dim0_offset;
             }
-            free(pred_buffer);
-            free(reg_params);
-
-//    printf("block %ld; lorenzo %ld, lorenzo_2layer %ld, regression %ld, poly regression %ld\n", size.num_blocks,
-//        lorenzo_count, lorenzo_2layer_count, reg_count);
-
-            return type;
+            group.reg_count = reg_count;
+            group.reg_params_type.resize(RegCoeffNum3d * reg_count);
+            group.reg_unpredictable_data.resize(reg_unpredictable_data_pos - group.reg_unpredictable_data.data());
         }
 
-        //T *
-//        meta_decompress_3d(const unsigned char *compressed, size_t r1, size_t r2, size_t r3) {
-        T *decompress_3d(std::vector<int> &quant_inds, T *dec_data) {
-
-            int *type = quant_inds.data();
-//            T *dec_data = new T[size.num_elements];
-//    dec_data_sp_float = (float *) dec_data;
-            const float *reg_params_pos = (const float *) (reg_params + RegCoeffNum3d);;
+        void decompress_group(const int *type, T *dec_data, const Group &group, Quantizer &quantizer) {
+            size_t offset = group.begin * size.block_size * size.dim0_offset;
+            const int *type_pos = type + offset;
+            const int *indicator_pos = indicator.data() + group.begin * size.num_y * size.num_z;
+            const float *reg_params_pos = group.reg_count ? group.reg_params.data() + RegCoeffNum3d : nullptr;
 
-            const int *type_pos = type;
-            const int *indicator_pos = indicator.data();
-//        const float *reg_params_pos = reg_params;
             // add one more ghost layer
             size_t buffer_dim0_offset =
                     (size.d2 + params.lorenzo_padding_layer) * (size.d3 + params.lorenzo_padding_layer);
             size_t buffer_dim1_offset = size.d3 + params.lorenzo_padding_layer;
-            T *pred_buffer = (T *) malloc(
-                    (size.block_size + params.lorenzo_padding_layer) * (size.d2 + params.lorenzo_padding_layer) *
-                    (size.d3 + params.lorenzo_padding_layer) * sizeof(T));
-            memset(pred_buffer, 0,
-                   (size.block_size + params.lorenzo_padding_layer) * (size.d2 + params.lorenzo_padding_layer) *
-                   (size.d3 + params.lorenzo_padding_layer) * sizeof(T));
-            T *x_data_pos = dec_data;
-            for (size_t i = 0; i < size.num_x; i++) {
+            std::vector<T> pred_buffer((size.block_size + params.lorenzo_padding_layer) * buffer_dim0_offset, 0);
+            T *x_data_pos = dec_data + offset;
+            for (size_t i = group.begin; i < group.end; i++) {
                 T *y_data_pos = x_data_pos;
-                T *pred_buffer_pos = pred_buffer;
+                T *pred_buffer_pos = pred_buffer.data();
                 for (size_t j = 0; j < size.num_y; j++) {
                     T *z_data_pos = y_data_pos;
                     for (size_t k = 0; k < size.num_z; k++) {
@@ -402,15 +446,10 @@ namespace SZ {
                     y_data_pos += size.block_size * size.dim1_offset;
                     pred_buffer_pos += size.block_size * buffer_dim1_offset - size.block_size * size.num_z;
                 }
-                memcpy(pred_buffer, pred_buffer + size.block_size * buffer_dim0_offset,
+                memcpy(pred_buffer.data(), pred_buffer.data() + size.block_size * buffer_dim0_offset,
                        params.lorenzo_padding_layer * buffer_dim0_offset * sizeof(T));
                 x_data_pos += size.block_size * size.dim0_offset;
             }
-            free(pred_buffer);
-
-//            free(unpred_count_buffer);
-//            free(unpred_data_buffer);
-            return dec_data;
         }
 
         inline void
@@ -421,6 +460,14 @@ namespace SZ {
                                        const int pred_dim,
                                        const bool use_lorenzo, const bool use_lorenzo_2layer,
                                        const bool use_regression) {
+            // sample points of the 2D and 1D views, see set_view()
+            if (RANK == 2) {
+                x = y;
+                y = 0;
+            } else if (RANK < 2) {
+                x = z;
+                y = z = 0;
+            }
             T noise = 0;
             T noise_2layer = 0;
             const T *cur_data_pos = data_pos + x * dim0_offset + y * dim1_offset + z;
@@ -478,7 +525,9 @@ namespace SZ {
             double err_lorenzo = 0;
             double err_lorenzo_2layer = 0;
             double err_reg = 0;
-            for (int i = 2; i < min_size - 1; i++) {
+            // the longer blocks of the 2D and 1D views are sampled about as densely as the 3D ones
+            const int step = RANK == 3 ? 1 : std::max(1, min_size / 8);
+            for (int i = 2; i < min_size - 1; i += step) {
                 int bmi = min_size - i;
                 meta_block_error_estimation_3d(data_pos, reg_params_pos, mean_info, i, i, i, dim0_offset, dim1_offset,
                                                precision, err_lorenzo, err_lorenzo_2layer, err_reg, pred_dim,
@@ -520,12 +569,9 @@ namespace SZ {
         meta_params params;
         SZMETA::DSize_3d size;
         double precision;
-        size_t reg_count = 0;
         std::vector<int> indicator;
-        int *reg_params_type = nullptr;
-        float *reg_unpredictable_data = nullptr;
-        float *reg_params = nullptr;
-        float *reg_unpredictable_data_pos;
+        std::vector<Group> groups;
+        int nThreads = 1;
 
         SZMETA::meanInfo<T> mean_info;  // not used
         int capacity = 0; // not used, capacity is controlled by quantizer
@@ -8,6 +8,7 @@
 #include "SZ3/def.hpp"
 #include "SZ3/predictor/Predictor.hpp"
 #include "SZ3/predictor/LorenzoPredictor.hpp"
+#include "SZ3/predictor/StaticComposedPredictor.hpp"
 #include "SZ3/quantizer/Quantizer.hpp"
 #include "SZ3/utils/Iterator.hpp"
 #include "SZ3/utils/Config.hpp"
@@ -46,15 +47,20 @@ namespace SZ {
 
                 element_range->update_block_range(block, block_size);
 
-                concepts::PredictorInterface<T, N> *predictor_withfallback = &predictor;
-                if (!predictor.precompress_block(element_range)) {
-                    predictor_withfallback = &fallback_predictor;
-                }
-                predictor_withfallback->precompress_block_commit();
-
-                for (auto element = element_range->begin(); element != element_range->end(); ++element) {
-                    quant_inds[quant_count++] = quantizer.quantize_and_overwrite(
-                            *element, predictor_withfallback->predict(element));
+                // the element loop is instantiated per concrete predictor type, so predict() is not a virtual call
+                auto compress_block = [&](auto &predictor_withfallback) {
+                    for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                        quant_inds[quant_count++] = quantizer.quantize_and_overwrite(
+                                *element, predictor_withfallback.predict(element));
+                    }
+                };
+                if (predictor.precompress_block(element_range)) {
+                    predictor.precompress_block_commit();
+                    dispatch_predictor(predictor, compress_block);
+                } else {
+                    fallback_predictor.precompress_block(element_range);
+                    fallback_predictor.precompress_block_commit();
+                    compress_block(fallback_predictor);
                 }
             }
 
@@ -81,12 +87,16 @@ namespace SZ {
 
                 element_range->update_block_range(block, block_size);
 
-                concepts::PredictorInterface<T, N> *predictor_withfallback = &predictor;
-                if (!predictor.predecompress_block(element_range)) {
-                    predictor_withfallback = &fallback_predictor;
-                }
-                for (auto element = element_range->begin(); element != element_range->end(); ++element) {
-                    *element = quantizer.recover(predictor_withfallback->predict(element), *(quant_inds_pos++));
+                auto decompress_block = [&](auto &predictor_withfallback) {
+                    for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                        *element = quantizer.recover(predictor_withfallback.predict(element), *(quant_inds_pos++));
+                    }
+                };
+                if (predictor.predecompress_block(element_range)) {
+                    dispatch_predictor(predictor, decompress_block);
+                } else {
+                    fallback_predictor.predecompress_block(element_range);
+                    decompress_block(fallback_predictor);
                 }
             }
             predictor.postdecompress_data(block_range->begin());
@@ -132,6 +142,8 @@ namespace SZ {
 
         size_t get_num_elements() const { return num_elements; };
 
+        const std::vector<size_t> &get_histogram() const { return quantizer.get_histogram(); }
+
     private:
         Predictor predictor;
         LorenzoPredictor<T, N, 1> fallback_predictor;
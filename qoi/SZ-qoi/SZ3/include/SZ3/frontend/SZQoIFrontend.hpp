@@ -8,6 +8,7 @@
 #include "SZ3/def.hpp"
 #include "SZ3/predictor/Predictor.hpp"
 #include "SZ3/predictor/LorenzoPredictor.hpp"
+#include "SZ3/predictor/StaticComposedPredictor.hpp"
 #include "SZ3/quantizer/Quantizer.hpp"
 #include "SZ3/qoi/QoI.hpp"
 #include "SZ3/utils/Iterator.hpp"
@@ -48,48 +49,59 @@ namespace SZ {
             for (auto block = block_range->begin(); block != block_range->end(); ++block) {
 
                 element_range->update_block_range(block, block_size);
+                if (source) {
+                    // the blocks before this one hold their reconstruction, as in place
+                    for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                        *element = source[element.get_offset()];
+                    }
+                }
                 qoi->precompress_block(element_range);
 
-                concepts::PredictorInterface<T, N> *predictor_withfallback = &predictor;
-                if (!predictor.precompress_block(element_range)) {
-                    predictor_withfallback = &fallback_predictor;
-                }
-                predictor_withfallback->precompress_block_commit();
-
-                for (auto element = element_range->begin(); element != element_range->end(); ++element) {
-                    auto ori_data = *element;
-                    // interpret the error bound for current data based on qoi
-                    auto eb = qoi->interpret_eb(element);
-
-                    quant_inds[quant_count] = quantizer_eb.quantize_and_overwrite(eb);
-                    quant_inds[num_elements + quant_count] = quantizer.quantize_and_overwrite(
-                            *element, predictor_withfallback->predict(element), eb);
-
-                    // if(element.get_offset() == 19733396){
-                        // auto pred = predictor_withfallback->predict(element);
-                        // std::cout << element.get_offset() << "->" << quant_count << ": eb = " << eb << ", quant_inds = " << quant_inds[quant_count] << std::endl;
-                        // std::cout << "eb = " << eb << std::endl;
-                        // std::cout << quant_inds[quant_count] << " " << quant_inds[num_elements + quant_count] << std::endl;
-                        // std::cout << ori_data << " " << *element << std::endl;
-                        // std::cout << "pred = " << predictor_withfallback->predict(element) << std::endl;
-                    //     auto temp = qoi.check_compliance(ori_data, *element, true);
-                    //     std::cout << "check_compliance = " << temp << std::endl;
-                    // }
-                    // check whether decompressed data is compliant with qoi tolerance
-                    if(!qoi->check_compliance(ori_data, *element)){
-                        // std::cout << "exceed in " << element.get_offset() << std::endl;
-                        // save as unpredictable
-                        eb = 0;
-                        *element = ori_data;
+                // the element loop is instantiated per concrete predictor type, so predict() is not a virtual call
+                auto compress_block = [&](auto &predictor_withfallback) {
+                    for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                        auto ori_data = *element;
+                        // interpret the error bound for current data based on qoi
+                        auto eb = qoi->interpret_eb(element);
+
                         quant_inds[quant_count] = quantizer_eb.quantize_and_overwrite(eb);
-                        if(quant_inds[num_elements + quant_count] != 0){
-                            // avoid push multiple elements
-                            quant_inds[num_elements + quant_count] = quantizer.quantize_and_overwrite(*element, 0, 0);                            
+                        quant_inds[num_elements + quant_count] = quantizer.quantize_and_overwrite(
+                                *element, predictor_withfallback.predict(element), eb);
+
+                        // if(element.get_offset() == 19733396){
+                            // auto pred = predictor_withfallback.predict(element);
+                            // std::cout << element.get_offset() << "->" << quant_count << ": eb = " << eb << ", quant_inds = " << quant_inds[quant_count] << std::endl;
+                            // std::cout << "eb = " << eb << std::endl;
+                            // std::cout << quant_inds[quant_count] << " " << quant_inds[num_elements + quant_count] << std::endl;
+                            // std::cout << ori_data << " " << *element << std::endl;
+                            // std::cout << "pred = " << predictor_withfallback.predict(element) << std::endl;
+                        //     auto temp = qoi.check_compliance(ori_data, *element, true);
+                        //     std::cout << "check_compliance = " << temp << std::endl;
+                        // }
+                        // check whether decompressed data is compliant with qoi tolerance
+                        if(!qoi->check_compliance(ori_data, *element)){
+                            // std::cout << "exceed in " << element.get_offset() << std::endl;
+                            // save as unpredictable
+                            eb = 0;
+                            *element = ori_data;
+                            quant_inds[quant_count] = quantizer_eb.quantize_and_overwrite(eb);
+                            if(quant_inds[num_elements + quant_count] != 0){
+                                // avoid push multiple elements
+                                quant_inds[num_elements + quant_count] = quantizer.quantize_and_overwrite(*element, 0, 0);                            
+                            }
                         }
+                        quant_count ++;
+                        // update cumulative tolerance if needed 
+                        qoi->update_tolerance(ori_data, *element);
                     }
-                    quant_count ++;
-                    // update cumulative tolerance if needed 
-                    qoi->update_tolerance(ori_data, *element);
+                };
+                if (predictor.precompress_block(element_range)) {
+                    predictor.precompress_block_commit();
+                    dispatch_predictor(predictor, compress_block);
+                } else {
+                    fallback_predictor.precompress_block(element_range);
+                    fallback_predictor.precompress_block_commit();
+                    compress_block(fallback_predictor);
                 }
                 qoi->postcompress_block();
             }
@@ -98,6 +110,14 @@ namespace SZ {
             return quant_inds;
         }
 
+        // the blocks are copied from source when they are reached, there is no copy of the whole data
+        std::vector<int> compress_from(const T *source, T *work, size_t) {
+            this->source = source;
+            auto quant_inds = compress(work);
+            this->source = nullptr;
+            return quant_inds;
+        }
+
         T *decompress(std::vector<int> &quant_inds, T *dec_data) {
 
             int const *quant_inds_eb_pos = (int const *) quant_inds.data();
@@ -117,13 +137,17 @@ namespace SZ {
 
                 element_range->update_block_range(block, block_size);
 
-                concepts::PredictorInterface<T, N> *predictor_withfallback = &predictor;
-                if (!predictor.predecompress_block(element_range)) {
-                    predictor_withfallback = &fallback_predictor;
-                }
-                for (auto element = element_range->begin(); element != element_range->end(); ++element) {
-                    auto eb = quantizer_eb.recover(*(quant_inds_eb_pos++));
-                    *element = quantizer.recover(predictor_withfallback->predict(element), *(quant_inds_pos++), eb);
+                auto decompress_block = [&](auto &predictor_withfallback) {
+                    for (auto element = element_range->begin(); element != element_range->end(); ++element) {
+                        auto eb = quantizer_eb.recover(*(quant_inds_eb_pos++));
+                        *element = quantizer.recover(predictor_withfallback.predict(element), *(quant_inds_pos++), eb);
+                    }
+                };
+                if (predictor.predecompress_block(element_range)) {
+                    dispatch_predictor(predictor, decompress_block);
+                } else {
+                    fallback_predictor.predecompress_block(element_range);
+                    decompress_block(fallback_predictor);
                 }
             }
             predictor.postdecompress_data(block_range->begin());
@@ -171,6 +195,9 @@ namespace SZ {
 
         size_t get_num_elements() const { return num_elements; };
 
+        // eb and data indices share one array, the histogram is not collected
+        const std::vector<size_t> &get_histogram() const { return histogram; }
+
     private:
         Predictor predictor;
         LorenzoPredictor<T, N, 1> fallback_predictor;
@@ -180,6 +207,8 @@ namespace SZ {
         uint block_size;
         size_t num_elements;
         std::array<size_t, N> global_dimensions;
+        std::vector<size_t> histogram;
+        const T *source = nullptr; // compress_from() only
     };
 
     template<class T, uint N, class Predictor, class Quantizer, class Quantizer_EB>
@@ -0,0 +1,143 @@
+#ifndef SZ3_WAVELET_FRONTEND
+#define SZ3_WAVELET_FRONTEND
+/**
+ * Transform-based frontend: the data are transformed with the N-D CDF 9/7 wavelet (SZ3/preprocessor/Wavelet.hpp),
+ * the coefficients are quantized with a uniform step and transformed back. The wavelet is not orthogonal in the
+ * max norm, so this approximation is then used as the prediction of every point and the residual is quantized with
+ * the error bound, which keeps the error of every point within the bound. Most residuals fall in the zero bin and
+ * cost little after the encoder and the lossless stage.
+ * The quantization indices are the coefficient indices followed by the residual indices.
+ */
+
+#include "Frontend.hpp"
+#include "SZ3/def.hpp"
+#include "SZ3/preprocessor/Wavelet.hpp"
+#include "SZ3/quantizer/IntegerQuantizer.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/MemoryUtil.hpp"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace SZ {
+
+
+    template<class T, uint N>
+    class SZWaveletFrontend : public concepts::FrontendInterface<T, N> {
+    public:
+        // coefficient step relative to the error bound
+        static constexpr double COEFF_STEP = 1.5;
+
+        SZWaveletFrontend(const Config &conf) :
+                coeff_quantizer(conf.absErrorBound * COEFF_STEP, conf.quantbinCnt / 2),
+                quantizer(conf.absErrorBound, conf.quantbinCnt / 2),
+                levels(6),
+                num_elements(conf.num) {
+            std::copy_n(conf.dims.begin(), N, global_dimensions.begin());
+#ifdef _OPENMP
+            if (conf.openmp) {
+                nThreads = conf.nThreads > 0 ? conf.nThreads : omp_get_max_threads();
+            }
+#endif
+        }
+
+        ~SZWaveletFrontend() = default;
+
+        std::vector<int> compress(T *data) {
+            std::vector<T> coeff(data, data + num_elements);
+            Wavelet<T, N> wavelet(levels, nThreads);
+            wavelet.preprocess(coeff.data(), global_dimensions);
+
+            std::vector<int> quant_inds(2 * num_elements);
+            coeff_quantizer.precompress_data();
+            for (size_t i = 0; i < num_elements; i++) {
+                quant_inds[i] = coeff_quantizer.quantize_and_overwrite(coeff[i], 0);
+            }
+            wavelet.postProcess(coeff.data(), global_dimensions);
+
+            quantizer.precompress_data();
+            for (size_t i = 0; i < num_elements; i++) {
+                quant_inds[num_elements + i] = quantizer.quantize_and_overwrite(data[i], coeff[i]);
+            }
+
+            histogram = coeff_quantizer.get_histogram();
+            const auto &residual_histogram = quantizer.get_histogram();
+            for (size_t i = 0; i < histogram.size(); i++) {
+                histogram[i] += residual_histogram[i];
+            }
+            return quant_inds;
+        }
+
+        T *decompress(std::vector<int> &quant_inds, T *dec_data) {
+            std::vector<T> coeff(num_elements);
+            for (size_t i = 0; i < num_elements; i++) {
+                coeff[i] = coeff_quantizer.recover(0, quant_inds[i]);
+            }
+            Wavelet<T, N> wavelet(levels, nThreads);
+            wavelet.postProcess(coeff.data(), global_dimensions);
+            for (size_t i = 0; i < num_elements; i++) {
+                dec_data[i] = quantizer.recover(coeff[i], quant_inds[num_elements + i]);
+            }
+            return dec_data;
+        }
+
+        void save(uchar *&c) {
+            write(global_dimensions.data(), N, c);
+            write(levels, c);
+            coeff_quantizer.save(c);
+            quantizer.save(c);
+        }
+
+        void load(const uchar *&c, size_t &remaining_length) {
+            clear();
+            read(global_dimensions.data(), N, c, remaining_length);
+            num_elements = 1;
+            for (const auto &d: global_dimensions) {
+                num_elements *= d;
+            }
+            read(levels, c, remaining_length);
+            coeff_quantizer.load(c, remaining_length);
+            quantizer.load(c, remaining_length);
+        }
+
+        size_t size_est() {
+            return sizeof(size_t) * N + sizeof(int) + coeff_quantizer.size_est() + quantizer.size_est() + 64
+                   + 2 * sizeof(T) * num_elements;
+        }
+
+        void print() {}
+
+        void clear() {
+            coeff_quantizer.clear();
+            quantizer.clear();
+            histogram.clear();
+        }
+
+        int get_radius() const { return quantizer.get_radius(); }
+
+        // both the coefficients and the residuals are encoded
+        size_t get_num_elements() const { return 2 * num_elements; };
+
+        const std::vector<size_t> &get_histogram() const { return histogram; }
+
+    private:
+        LinearQuantizer<T> coeff_quantizer;
+        LinearQuantizer<T> quantizer;
+        int levels;
+        int nThreads = 1;
+        std::array<size_t, N> global_dimensions;
+        size_t num_elements;
+        std::vector<size_t> histogram;
+    };
+
+    template<class T, uint N>
+    SZWaveletFrontend<T, N> make_sz_wavelet_frontend(const Config &conf) {
+        return SZWaveletFrontend<T, N>(conf);
+    }
+}
+
+#endif
@@ -9,7 +9,10 @@
 #include "SZ3/def.hpp"
 #include "SZ3/utils/MemoryUtil.hpp"
 #include "SZ3/utils/FileUtil.hpp"
+#include "SZ3/utils/Profiler.hpp"
 #include "SZ3/lossless/Lossless.hpp"
+#include <cstring>
+#include <vector>
 
 namespace SZ {
     class Lossless_zstd : public concepts::LosslessInterface {
@@ -20,14 +23,24 @@ namespace SZ {
         Lossless_zstd(int comp_level) : compression_level(comp_level) {};
 
         uchar *compress(uchar *data, size_t dataLength, size_t &outSize) {
+            ProfileScope scope(STAGE_LOSSLESS, dataLength);
             size_t estimatedCompressedSize = dataLength < 100 ? 200 : dataLength * 1.2;
             uchar *compressBytes = new uchar[estimatedCompressedSize];
             uchar *compressBytesPos = compressBytes;
+            if (!worth_compressing(data, dataLength)) {
+                // the encoded data are already close to their entropy, store them
+                write(dataLength | STORED, compressBytesPos);
+                memcpy(compressBytesPos, data, dataLength);
+                outSize = sizeof(size_t) + dataLength;
+                scope.add_bytes_out(outSize);
+                return compressBytes;
+            }
             write(dataLength, compressBytesPos);
 
             outSize = ZSTD_compress(compressBytesPos, estimatedCompressedSize, data, dataLength,
                                     compression_level);
             outSize += sizeof(size_t);
+            scope.add_bytes_out(outSize);
             return compressBytes;
         }
 
@@ -36,13 +49,21 @@ namespace SZ {
         }
 
         uchar *decompress(const uchar *data, size_t &compressedSize) {
+            ProfileScope scope(STAGE_LOSSLESS, compressedSize);
             const uchar *dataPos = data;
             size_t dataLength = 0;
             read(dataLength, dataPos, compressedSize);
 
+            bool stored = dataLength & STORED;
+            dataLength &= ~STORED;
             uchar *oriData = new uchar[dataLength];
-            ZSTD_decompress(oriData, dataLength, dataPos, compressedSize);
+            if (stored) {
+                memcpy(oriData, dataPos, dataLength);
+            } else {
+                ZSTD_decompress(oriData, dataLength, dataPos, compressedSize);
+            }
             compressedSize = dataLength;
+            scope.add_bytes_out(dataLength);
             return oriData;
         }
 
@@ -51,6 +72,33 @@ namespace SZ {
         }
 
     private:
+        // flag in the length header of data stored without zstd
+        static constexpr size_t STORED = (size_t) 1 << (sizeof(size_t) * 8 - 1);
+
+        /*
+         * whether zstd gains at least 2% on the data
+         * Huffman-coded data are often close to their entropy, so 8 evenly spaced slices of 8KB are compressed at
+         * level 1 first; this costs little compared to a zstd pass that would be thrown away.
+         */
+        bool worth_compressing(const uchar *data, size_t dataLength) const {
+            const size_t slice = 8192, slices = 8;
+            if (dataLength < 4 * slices * slice) {
+                return true;
+            }
+            std::vector<uchar> buffer(ZSTD_compressBound(slice));
+            size_t raw = 0, compressed = 0;
+            for (size_t i = 0; i < slices; i++) {
+                size_t offset = i * (dataLength - slice) / (slices - 1);
+                size_t size = ZSTD_compress(buffer.data(), buffer.size(), data + offset, slice, 1);
+                if (ZSTD_isError(size)) {
+                    return true;
+                }
+                raw += slice;
+                compressed += size;
+            }
+            return compressed < raw * 0.98;
+        }
+
         int compression_level = 3;  //default setting of level is 3
     };
 }
@@ -10,7 +10,7 @@ namespace SZ {
 
     // N-dimension L-layer lorenzo predictor
     template<class T, uint N, uint L>
-    class LorenzoPredictor : public concepts::PredictorInterface<T, N> {
+    class LorenzoPredictor final : public concepts::PredictorInterface<T, N> {
     public:
         static const uint8_t predictor_id = 0b00000001;
         using Range = multi_dimensional_range<T, N>;
@@ -51,11 +51,17 @@ namespace SZ {
 
         void postdecompress_data(const iterator &) const {}
 
-        bool precompress_block(const std::shared_ptr<Range> &) { return true; }
+        bool precompress_block(const std::shared_ptr<Range> &range) {
+            update_offsets(range);
+            return true;
+        }
 
         void precompress_block_commit() noexcept {}
 
-        bool predecompress_block(const std::shared_ptr<Range> &) { return true; }
+        bool predecompress_block(const std::shared_ptr<Range> &range) {
+            update_offsets(range);
+            return true;
+        }
 
         /*
          * save doesn't need to store anything except the id
@@ -93,6 +99,9 @@ namespace SZ {
         }
 
         inline T predict(const iterator &iter) const noexcept {
+            if (iter.prev_in_range(layers)) {
+                return do_predict(&*iter);
+            }
             return do_predict(iter);
         }
 
@@ -102,56 +111,100 @@ namespace SZ {
         T noise = 0;
 
     private:
+        struct stencil_point {
+            int coeff;
+            std::array<int, N> pos;
+        };
+
+        // 4D always uses the 1-layer stencil
+        static constexpr uint layers = (N == 4) ? 1 : L;
+
+        /*
+         * Lorenzo stencil as (coefficient, position) pairs, where the position is in the format of iterator::prev().
+         * The order of the terms is part of the compressed format, since it determines the rounding of the prediction.
+         */
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 1 && LL == 1, T>::type do_predict(const iterator &iter) const noexcept {
-            return iter.prev(1);
+        static constexpr typename std::enable_if<NN == 1 && LL == 1, std::array<stencil_point, 1>>::type stencil() {
+            return {{{1, {1}}}};
         }
 
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 2 && LL == 1, T>::type do_predict(const iterator &iter) const noexcept {
-            return iter.prev(0, 1) + iter.prev(1, 0) - iter.prev(1, 1);
+        static constexpr typename std::enable_if<NN == 2 && LL == 1, std::array<stencil_point, 3>>::type stencil() {
+            return {{{1, {0, 1}}, {1, {1, 0}}, {-1, {1, 1}}}};
         }
 
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 3 && LL == 1, T>::type do_predict(const iterator &iter) const noexcept {
-            return iter.prev(0, 0, 1) + iter.prev(0, 1, 0) + iter.prev(1, 0, 0)
-                   - iter.prev(0, 1, 1) - iter.prev(1, 0, 1) - iter.prev(1, 1, 0)
-                   + iter.prev(1, 1, 1);
-
+        static constexpr typename std::enable_if<NN == 3 && LL == 1, std::array<stencil_point, 7>>::type stencil() {
+            return {{{1, {0, 0, 1}}, {1, {0, 1, 0}}, {1, {1, 0, 0}},
+                     {-1, {0, 1, 1}}, {-1, {1, 0, 1}}, {-1, {1, 1, 0}},
+                     {1, {1, 1, 1}}}};
         }
 
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 4, T>::type do_predict(const iterator &iter) const noexcept {
-            return iter.prev(0, 0, 0, 1) + iter.prev(0, 0, 1, 0) - iter.prev(0, 0, 1, 1) + iter.prev(0, 1, 0, 0)
-                   - iter.prev(0, 1, 0, 1) - iter.prev(0, 1, 1, 0) + iter.prev(0, 1, 1, 1) + iter.prev(1, 0, 0, 0)
-                   - iter.prev(1, 0, 0, 1) - iter.prev(1, 0, 1, 0) + iter.prev(1, 0, 1, 1) - iter.prev(1, 1, 0, 0)
-                   + iter.prev(1, 1, 0, 1) + iter.prev(1, 1, 1, 0) - iter.prev(1, 1, 1, 1);
+        static constexpr typename std::enable_if<NN == 4, std::array<stencil_point, 15>>::type stencil() {
+            return {{{1, {0, 0, 0, 1}}, {1, {0, 0, 1, 0}}, {-1, {0, 0, 1, 1}}, {1, {0, 1, 0, 0}},
+                     {-1, {0, 1, 0, 1}}, {-1, {0, 1, 1, 0}}, {1, {0, 1, 1, 1}}, {1, {1, 0, 0, 0}},
+                     {-1, {1, 0, 0, 1}}, {-1, {1, 0, 1, 0}}, {1, {1, 0, 1, 1}}, {-1, {1, 1, 0, 0}},
+                     {1, {1, 1, 0, 1}}, {1, {1, 1, 1, 0}}, {-1, {1, 1, 1, 1}}}};
         }
 
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 1 && LL == 2, T>::type do_predict(const iterator &iter) const noexcept {
-            return 2 * iter.prev(1) - iter.prev(2);
+        static constexpr typename std::enable_if<NN == 1 && LL == 2, std::array<stencil_point, 2>>::type stencil() {
+            return {{{2, {1}}, {-1, {2}}}};
         }
 
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 2 && LL == 2, T>::type do_predict(const iterator &iter) const noexcept {
-            return 2 * iter.prev(0, 1) - iter.prev(0, 2) + 2 * iter.prev(1, 0)
-                   - 4 * iter.prev(1, 1) + 2 * iter.prev(1, 2) - iter.prev(2, 0)
-                   + 2 * iter.prev(2, 1) - iter.prev(2, 2);
+        static constexpr typename std::enable_if<NN == 2 && LL == 2, std::array<stencil_point, 8>>::type stencil() {
+            return {{{2, {0, 1}}, {-1, {0, 2}}, {2, {1, 0}},
+                     {-4, {1, 1}}, {2, {1, 2}}, {-1, {2, 0}},
+                     {2, {2, 1}}, {-1, {2, 2}}}};
         }
 
         template<uint NN = N, uint LL = L>
-        inline typename std::enable_if<NN == 3 && LL == 2, T>::type do_predict(const iterator &iter) const noexcept {
-            return 2 * iter.prev(0, 0, 1) - iter.prev(0, 0, 2) + 2 * iter.prev(0, 1, 0)
-                   - 4 * iter.prev(0, 1, 1) + 2 * iter.prev(0, 1, 2) - iter.prev(0, 2, 0)
-                   + 2 * iter.prev(0, 2, 1) - iter.prev(0, 2, 2) + 2 * iter.prev(1, 0, 0)
-                   - 4 * iter.prev(1, 0, 1) + 2 * iter.prev(1, 0, 2) - 4 * iter.prev(1, 1, 0)
-                   + 8 * iter.prev(1, 1, 1) - 4 * iter.prev(1, 1, 2) + 2 * iter.prev(1, 2, 0)
-                   - 4 * iter.prev(1, 2, 1) + 2 * iter.prev(1, 2, 2) - iter.prev(2, 0, 0)
-                   + 2 * iter.prev(2, 0, 1) - iter.prev(2, 0, 2) + 2 * iter.prev(2, 1, 0)
-                   - 4 * iter.prev(2, 1, 1) + 2 * iter.prev(2, 1, 2) - iter.prev(2, 2, 0)
-                   + 2 * iter.prev(2, 2, 1) - iter.prev(2, 2, 2);
-        };
+        static constexpr typename std::enable_if<NN == 3 && LL == 2, std::array<stencil_point, 26>>::type stencil() {
+            return {{{2, {0, 0, 1}}, {-1, {0, 0, 2}}, {2, {0, 1, 0}},
+                     {-4, {0, 1, 1}}, {2, {0, 1, 2}}, {-1, {0, 2, 0}},
+                     {2, {0, 2, 1}}, {-1, {0, 2, 2}}, {2, {1, 0, 0}},
+                     {-4, {1, 0, 1}}, {2, {1, 0, 2}}, {-4, {1, 1, 0}},
+                     {8, {1, 1, 1}}, {-4, {1, 1, 2}}, {2, {1, 2, 0}},
+                     {-4, {1, 2, 1}}, {2, {1, 2, 2}}, {-1, {2, 0, 0}},
+                     {2, {2, 0, 1}}, {-1, {2, 0, 2}}, {2, {2, 1, 0}},
+                     {-4, {2, 1, 1}}, {2, {2, 1, 2}}, {-1, {2, 2, 0}},
+                     {2, {2, 2, 1}}, {-1, {2, 2, 2}}}};
+        }
+
+        using stencil_type = decltype(stencil());
+        static constexpr size_t stencil_size = std::tuple_size<stencil_type>::value;
+        const stencil_type points = stencil();
+        std::array<ptrdiff_t, stencil_size> offsets{};   // offsets of the stencil in the current range
+
+        void update_offsets(const std::shared_ptr<Range> &range) {
+            auto strides = range->get_global_dim_strides();
+            for (size_t k = 0; k < stencil_size; k++) {
+                offsets[k] = 0;
+                for (int i = 0; i < N; i++) {
+                    offsets[k] += points[k].pos[i] * strides[i];
+                }
+            }
+        }
+
+        // interior elements: all neighbors are read directly from the data pointer
+        inline T do_predict(const T *p) const noexcept {
+            T pred = points[0].coeff * p[-offsets[0]];
+            for (size_t k = 1; k < stencil_size; k++) {
+                pred += points[k].coeff * p[-offsets[k]];
+            }
+            return pred;
+        }
+
+        // elements at the left boundary of the data: out-of-range neighbors are treated as 0
+        inline T do_predict(const iterator &iter) const noexcept {
+            T pred = points[0].coeff * iter.prev(points[0].pos);
+            for (size_t k = 1; k < stencil_size; k++) {
+                pred += points[k].coeff * iter.prev(points[k].pos);
+            }
+            return pred;
+        }
     };
 }
 #endif
@@ -52,10 +52,9 @@ namespace SZMETA {
 
     template<typename T>
     float *
-    decode_regression_coefficients(const unsigned char *&compressed_pos, size_t reg_count, int block_size, T precision,
-                                   const meta_params &params) {
+    decode_regression_coefficients(const unsigned char *&compressed_pos, size_t &remaining_length, size_t reg_count,
+                                   int block_size, T precision, const meta_params &params) {
         size_t reg_unpredictable_count = 0;
-        size_t remaining_length = RegCoeffNum3d * reg_count;//fake, has no meaning
         SZ::read(reg_unpredictable_count, compressed_pos, remaining_length);
         const float *reg_unpredictable_data_pos = (const float *) compressed_pos;
         compressed_pos += reg_unpredictable_count * sizeof(float);
@@ -135,9 +134,10 @@ namespace SZMETA {
             cur_data_pos += (dim0_offset - size_y * dim1_offset);
         }
         float coeff = 1.0 / (size_x * size_y * size_z);
-        reg_params_pos[0] = (2 * fx / (size_x - 1) - f) * 6 * coeff / (size_x + 1);
-        reg_params_pos[1] = (2 * fy / (size_y - 1) - f) * 6 * coeff / (size_y + 1);
-        reg_params_pos[2] = (2 * fz / (size_z - 1) - f) * 6 * coeff / (size_z + 1);
+        // no slope along a dimension of 1
+        reg_params_pos[0] = size_x > 1 ? (2 * fx / (size_x - 1) - f) * 6 * coeff / (size_x + 1) : 0;
+        reg_params_pos[1] = size_y > 1 ? (2 * fy / (size_y - 1) - f) * 6 * coeff / (size_y + 1) : 0;
+        reg_params_pos[2] = size_z > 1 ? (2 * fz / (size_z - 1) - f) * 6 * coeff / (size_z + 1) : 0;
         reg_params_pos[3] = f * coeff - ((size_x - 1) * reg_params_pos[0] / 2 + (size_y - 1) * reg_params_pos[1] / 2 +
                                          (size_z - 1) * reg_params_pos[2] / 2);
     }
@@ -0,0 +1,294 @@
+#ifndef _SZ_STATIC_COMPOSED_PREDICTOR_HPP
+#define _SZ_STATIC_COMPOSED_PREDICTOR_HPP
+
+/**
+ * Compile-time counterpart of ComposedPredictor.
+ * Predictors are stored by value in a tuple, so block selection and prediction
+ * do not go through virtual calls. Frontends use dispatch_predictor() to run
+ * the per-element loop of a block on the selected predictor directly.
+ * The serialized format is the same as ComposedPredictor with the same predictor list.
+ */
+
+#include "SZ3/def.hpp"
+#include "SZ3/utils/Iterator.hpp"
+#include "SZ3/predictor/Predictor.hpp"
+#include "SZ3/encoder/HuffmanEncoder.hpp"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace SZ {
+
+    template<class T, uint N, class... Predictors>
+    class StaticComposedPredictor : public concepts::PredictorInterface<T, N> {
+    public:
+        using Range = multi_dimensional_range<T, N>;
+        using iterator = typename multi_dimensional_range<T, N>::iterator;
+        static constexpr size_t num_predictors = sizeof...(Predictors);
+
+        static_assert(num_predictors > 0, "StaticComposedPredictor needs at least one predictor");
+
+        StaticComposedPredictor(Predictors... ps) : predictors(std::move(ps)...) {}
+
+        void precompress_data(const iterator &iter) const noexcept {
+            for_each([&](const auto &p, size_t) { p.precompress_data(iter); });
+        }
+
+        void postcompress_data(const iterator &iter) const noexcept {
+            for_each([&](const auto &p, size_t) { p.postcompress_data(iter); });
+        }
+
+        void predecompress_data(const iterator &iter) const noexcept {
+            for_each([&](const auto &p, size_t) { p.predecompress_data(iter); });
+        }
+
+        void postdecompress_data(const iterator &iter) const noexcept {
+            for_each([&](const auto &p, size_t) { p.postdecompress_data(iter); });
+        }
+
+        bool precompress_block(const std::shared_ptr<Range> &range) {
+            std::array<bool, num_predictors> precompress_block_result;
+            for_each([&](auto &p, size_t i) { precompress_block_result[i] = p.precompress_block(range); });
+
+            const auto &dims = range->get_dimensions();
+            int min_dimension = *std::min_element(dims.begin(), dims.end());
+
+            predict_error.fill(0);
+            auto begin = range->begin();
+            for_each([&](const auto &p, size_t i) { predict_error[i] = do_estimate_error(p, begin, min_dimension); });
+
+            sid = std::distance(predict_error.begin(), std::min_element(predict_error.begin(), predict_error.end()));
+            return precompress_block_result[sid];
+        }
+
+        void precompress_block_commit() {
+            selection.push_back(sid);
+            dispatch([](auto &p) { p.precompress_block_commit(); });
+        }
+
+        bool predecompress_block(const std::shared_ptr<Range> &range) {
+            sid = selection[current_index++];
+            bool result = false;
+            dispatch([&](auto &p) { result = p.predecompress_block(range); });
+            return result;
+        }
+
+        void save(uchar *&c) const {
+            for_each([&](const auto &p, size_t) { p.save(c); });
+
+            *reinterpret_cast<size_t *>(c) = (size_t) selection.size();
+            c += sizeof(size_t);
+            if (selection.size()) {
+                HuffmanEncoder<int> selection_encoder;
+                selection_encoder.preprocess_encode(selection, 0);
+                selection_encoder.save(c);
+                selection_encoder.encode(selection, c);
+                selection_encoder.postprocess_encode();
+            }
+        }
+
+        void load(const uchar *&c, size_t &remaining_length) {
+            for_each([&](auto &p, size_t) { p.load(c, remaining_length); });
+
+            size_t selection_size = *reinterpret_cast<const size_t *>(c);
+            c += sizeof(size_t);
+            if (selection_size > 0) {
+                remaining_length -= sizeof(size_t);
+                HuffmanEncoder<int> selection_encoder;
+                selection_encoder.load(c, remaining_length);
+                this->selection = selection_encoder.decode(c, selection_size);
+                selection_encoder.postprocess_decode();
+            }
+            current_index = 0;
+        }
+
+        // per-element entry points; hot loops should use dispatch() instead
+        inline T predict(const iterator &iter) const noexcept {
+            T pred = 0;
+            dispatch([&](const auto &p) { pred = p.predict(iter); });
+            return pred;
+        }
+
+        T estimate_error(const iterator &iter) const noexcept {
+            T err = 0;
+            dispatch([&](const auto &p) { err = p.estimate_error(iter); });
+            return err;
+        }
+
+        // call func with the currently selected predictor as its concrete type
+        template<class Func>
+        inline void dispatch(Func &&func) {
+            dispatch_impl(func, std::make_index_sequence<num_predictors>{});
+        }
+
+        template<class Func>
+        inline void dispatch(Func &&func) const {
+            dispatch_impl(func, std::make_index_sequence<num_predictors>{});
+        }
+
+        int get_sid() const { return sid; }
+
+        void set_sid(int _sid) {
+            sid = _sid;
+        }
+
+        void print() const {
+            std::array<size_t, num_predictors> cnt{0};
+            size_t cnt_total = 0;
+            for (auto &sel:selection) {
+                cnt[sel]++;
+                cnt_total++;
+            }
+            for (int i = 0; i < num_predictors; i++) {
+                printf("Blocks:%ld, Percentage:%.2f\n", cnt[i], 1.0 * cnt[i] / cnt_total);
+            }
+        }
+
+        void clear() {
+            for_each([](auto &p, size_t) { p.clear(); });
+            selection.clear();
+            current_index = 0;
+        }
+
+    private:
+        std::tuple<Predictors...> predictors;
+        std::vector<int> selection;
+        int sid = 0;                            // selected index
+        size_t current_index = 0;               // for decompression only
+        std::array<double, num_predictors> predict_error{0};
+
+        template<class Func>
+        inline void for_each(Func &&func) {
+            for_each_impl(func, std::make_index_sequence<num_predictors>{});
+        }
+
+        template<class Func>
+        inline void for_each(Func &&func) const {
+            for_each_impl(func, std::make_index_sequence<num_predictors>{});
+        }
+
+        template<class Func, size_t... Is>
+        inline void for_each_impl(Func &func, std::index_sequence<Is...>) {
+            (func(std::get<Is>(predictors), Is), ...);
+        }
+
+        template<class Func, size_t... Is>
+        inline void for_each_impl(Func &func, std::index_sequence<Is...>) const {
+            (func(std::get<Is>(predictors), Is), ...);
+        }
+
+        template<class Func, size_t... Is>
+        inline void dispatch_impl(Func &func, std::index_sequence<Is...>) {
+            ((sid == Is ? (func(std::get<Is>(predictors)), true) : false) || ...);
+        }
+
+        template<class Func, size_t... Is>
+        inline void dispatch_impl(Func &func, std::index_sequence<Is...>) const {
+            ((sid == Is ? (func(std::get<Is>(predictors)), true) : false) || ...);
+        }
+
+        // same sampling pattern as ComposedPredictor::do_estimate_error
+        template<class P, uint NN = N>
+        inline typename std::enable_if<NN == 1, double>::type
+        do_estimate_error(const P &p, const iterator &iter, int min_dimension) const {
+            double err = 0;
+            auto iter1 = iter;
+            iter1.move(min_dimension - 1);
+            err += p.estimate_error(iter);
+            err += p.estimate_error(iter1);
+            return err;
+        }
+
+        template<class P, uint NN = N>
+        inline typename std::enable_if<NN == 2, double>::type
+        do_estimate_error(const P &p, const iterator &iter, int min_dimension) const {
+            double err = 0;
+            auto iter1 = iter, iter2 = iter;
+            iter2.move(0, min_dimension - 1);
+            for (int i = 2; i < min_dimension; i++) {
+                err += p.estimate_error(iter1);
+                err += p.estimate_error(iter2);
+                iter1.move(1, 1);
+                iter2.move(1, -1);
+            }
+            return err;
+        }
+
+        template<class P, uint NN = N>
+        inline typename std::enable_if<NN == 3, double>::type
+        do_estimate_error(const P &p, const iterator &iter, int min_dimension) const {
+            double err = 0;
+            auto iter1 = iter, iter2 = iter, iter3 = iter, iter4 = iter;
+            iter2.move(0, 0, min_dimension - 1);
+            iter3.move(0, min_dimension - 1, 0);
+            iter4.move(0, min_dimension - 1, min_dimension - 1);
+            for (int i = 2; i < min_dimension; i++) {
+                err += p.estimate_error(iter1);
+                err += p.estimate_error(iter2);
+                err += p.estimate_error(iter3);
+                err += p.estimate_error(iter4);
+                iter1.move(1, 1, 1);
+                iter2.move(1, 1, -1);
+                iter3.move(1, -1, 1);
+                iter4.move(1, -1, -1);
+            }
+            return err;
+        }
+
+        template<class P, uint NN = N>
+        inline typename std::enable_if<NN >= 4, double>::type
+        do_estimate_error(const P &p, const iterator &iter, int min_dimension) const {
+            double err = 0;
+            auto iter1 = iter, iter2 = iter, iter3 = iter, iter4 = iter,
+                    iter5 = iter, iter6 = iter, iter7 = iter, iter8 = iter;
+            iter2.move(0, 0, 0, min_dimension - 1);
+            iter3.move(0, 0, min_dimension - 1, 0);
+            iter4.move(0, 0, min_dimension - 1, min_dimension - 1);
+            iter5.move(0, min_dimension - 1, 0, 0);
+            iter6.move(0, min_dimension - 1, 0, min_dimension - 1);
+            iter7.move(0, min_dimension - 1, min_dimension - 1, 0);
+            iter8.move(0, min_dimension - 1, min_dimension - 1, min_dimension - 1);
+            for (int i = 2; i < min_dimension; i++) {
+                err += p.estimate_error(iter1);
+                err += p.estimate_error(iter2);
+                err += p.estimate_error(iter3);
+                err += p.estimate_error(iter4);
+                err += p.estimate_error(iter5);
+                err += p.estimate_error(iter6);
+                err += p.estimate_error(iter7);
+                err += p.estimate_error(iter8);
+                iter1.move(1, 1, 1, 1);
+                iter2.move(1, 1, 1, -1);
+                iter3.move(1, 1, -1, 1);
+                iter4.move(1, 1, -1, -1);
+                iter5.move(1, -1, 1, 1);
+                iter6.move(1, -1, 1, -1);
+                iter7.move(1, -1, -1, 1);
+                iter8.move(1, -1, -1, -1);
+            }
+            return err;
+        }
+    };
+
+    template<class T, uint N, class... Predictors>
+    StaticComposedPredictor<T, N, Predictors...>
+    make_static_composed_predictor(Predictors... ps) {
+        return StaticComposedPredictor<T, N, Predictors...>(ps...);
+    }
+
+    // run func on the predictor that is active for the current block;
+    // for StaticComposedPredictor this resolves the selection to a concrete type once per block
+    template<class Predictor, class Func>
+    inline void dispatch_predictor(Predictor &predictor, Func &&func) {
+        func(predictor);
+    }
+
+    template<class T, uint N, class... Predictors, class Func>
+    inline void dispatch_predictor(StaticComposedPredictor<T, N, Predictors...> &predictor, Func &&func) {
+        predictor.dispatch(func);
+    }
+}
+
+#endif
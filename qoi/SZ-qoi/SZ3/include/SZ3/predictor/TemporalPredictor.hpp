@@ -0,0 +1,113 @@
+#ifndef _SZ_TEMPORAL_PREDICTOR_HPP
+#define _SZ_TEMPORAL_PREDICTOR_HPP
+
+#include "SZ3/def.hpp"
+#include "SZ3/predictor/Predictor.hpp"
+#include "SZ3/utils/Iterator.hpp"
+#include <cassert>
+
+namespace SZ {
+
+    /*
+     * N-dimension temporal predictor
+     * Predicts from the reconstructed field of the previous timestep, which has the same dimensions as the current one.
+     * L = 0: the value at the same position in the previous timestep
+     * L = 1: temporal lorenzo, the previous value plus the 1-layer lorenzo prediction of the difference between the steps
+     */
+    template<class T, uint N, uint L>
+    class TemporalPredictor final : public concepts::PredictorInterface<T, N> {
+    public:
+        static const uint8_t predictor_id = 0b00000100;
+        using Range = multi_dimensional_range<T, N>;
+        using iterator = typename multi_dimensional_range<T, N>::iterator;
+
+        TemporalPredictor() = default;
+
+        TemporalPredictor(const T *prev, double eb) : prev(prev) {
+            static_assert(L <= 1, "TemporalPredictor only supports L = 0 and L = 1");
+            // the previous step is exact on both sides, so the noise only comes from the lorenzo part
+            if (L == 1) {
+                const double lorenzo_noise[] = {0, 0.5, 0.81, 1.22, 1.79};
+                this->noise = (N <= 4 ? lorenzo_noise[N] : lorenzo_noise[4]) * eb;
+            }
+        }
+
+        void precompress_data(const iterator &) const {}
+
+        void postcompress_data(const iterator &) const {}
+
+        void predecompress_data(const iterator &) const {}
+
+        void postdecompress_data(const iterator &) const {}
+
+        bool precompress_block(const std::shared_ptr<Range> &range) {
+            update_offsets(range);
+            return true;
+        }
+
+        void precompress_block_commit() noexcept {}
+
+        bool predecompress_block(const std::shared_ptr<Range> &range) {
+            update_offsets(range);
+            return true;
+        }
+
+        void save(uchar *&c) const {
+            c[0] = predictor_id;
+            c += sizeof(uint8_t);
+        }
+
+        void load(const uchar *&c, size_t &remaining_length) {
+            c += sizeof(uint8_t);
+            remaining_length -= sizeof(uint8_t);
+        }
+
+        void print() const {
+            std::cout << N << "D temporal predictor, L = " << L << ", noise = " << noise << "\n";
+        }
+
+        inline T estimate_error(const iterator &iter) const noexcept {
+            return fabs(*iter - predict(iter)) + this->noise;
+        }
+
+        inline T predict(const iterator &iter) const noexcept {
+            const T *q = prev + iter.get_offset();
+            if (L == 0 || !iter.prev_in_range(1)) {
+                return q[0];
+            }
+            const T *p = &*iter;
+            T pred = q[0];
+            for (size_t k = 0; k < stencil_size; k++) {
+                pred += coeffs[k] * (p[-offsets[k]] - q[-offsets[k]]);
+            }
+            return pred;
+        }
+
+        void clear() {}
+
+    private:
+        static constexpr size_t stencil_size = (1 << N) - 1;
+
+        const T *prev = nullptr;
+        T noise = 0;
+        // 1-layer lorenzo stencil, one point per non-empty subset of the dimensions
+        std::array<int, stencil_size> coeffs{};
+        std::array<ptrdiff_t, stencil_size> offsets{};
+
+        void update_offsets(const std::shared_ptr<Range> &range) {
+            auto strides = range->get_global_dim_strides();
+            for (size_t mask = 1; mask <= stencil_size; mask++) {
+                int bits = 0;
+                offsets[mask - 1] = 0;
+                for (uint i = 0; i < N; i++) {
+                    if (mask & (1 << i)) {
+                        offsets[mask - 1] += strides[i];
+                        bits++;
+                    }
+                }
+                coeffs[mask - 1] = (bits % 2) ? 1 : -1;
+            }
+        }
+    };
+}
+#endif
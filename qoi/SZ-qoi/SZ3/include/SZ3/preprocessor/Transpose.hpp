@@ -5,79 +5,118 @@
 #ifndef SZ3_TRANSPOSE_H
 #define SZ3_TRANSPOSE_H
 
+/**
+ * Permutation of the dimensions of a field: dimension k of the result is dimension axes[k] of the input.
+ * When the fastest dimension changes, the copy goes tile by tile over the fastest dimensions of the input and of the
+ * result, so that both are read and written in contiguous runs of TILE elements; otherwise whole rows are copied.
+ * Tiles are spread over nThreads threads.
+ */
+
 #include "SZ3/preprocessor/PreProcessor.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <vector>
 
 namespace SZ {
     template<class T, uint N>
 
     class Transpose : public concepts::PreprocessorInterface<T, N> {
     public:
+        static const size_t TILE = 32;
+
+        Transpose(int nThreads = 1) : nThreads(nThreads) {}
+
+        // in place, dims are the dimensions of the input
         void preprocess(T *data, std::array<size_t, N> dims, std::array<size_t, N> axes) {
             static_assert(N < 5, "Data in 5D and above is not supported yet.");
             if (N == 1) {
                 return;
             }
-            size_t num = dims[N - 1];
-            std::array<size_t, N> stride;
-            stride[N - 1] = 1;
-            for (int i = N - 2; i >= 0; i--) {
-                stride[i] = stride[i + 1] * dims[i + 1];
-                num *= dims[i];
-            }
-            std::vector<T> ori(data, data + num);
-            transpose(data, dims, axes, ori.data(), stride);
+            std::vector<T> ori(data, data + num_elements(dims));
+            transpose(ori.data(), data, dims, axes);
         }
 
-    private:
-        template<uint NN = N>
-        inline typename std::enable_if<NN == 2, void>::type
-        transpose(T *data, std::array<size_t, N> dims, std::array<size_t, N> axes, T *ori,
-                  std::array<size_t, N> stride) {
-            size_t idx = 0;
-            for (size_t i = 0; i < dims[axes[0]]; i++) {
-                for (size_t j = 0; j < dims[axes[1]]; j++) {
-                    data[idx++] = ori[i * stride[axes[0]]
-                                      + j * stride[axes[1]]];
-                }
+        // undo preprocess() in place, dims are the dimensions given to preprocess()
+        void postProcess(T *data, std::array<size_t, N> dims, std::array<size_t, N> axes) {
+            if (N == 1) {
+                return;
             }
+            std::array<size_t, N> transposed_dims, inverse;
+            for (uint k = 0; k < N; k++) {
+                transposed_dims[k] = dims[axes[k]];
+                inverse[axes[k]] = k;
+            }
+            preprocess(data, transposed_dims, inverse);
         }
 
-        template<uint NN = N>
-        inline typename std::enable_if<NN == 3, void>::type
-        transpose(T *data, std::array<size_t, N> dims, std::array<size_t, N> axes, T *ori,
-                  std::array<size_t, N> stride) {
-            size_t idx = 0;
-            for (size_t i = 0; i < dims[axes[0]]; i++) {
-                for (size_t j = 0; j < dims[axes[1]]; j++) {
-                    for (size_t k = 0; k < dims[axes[2]]; k++) {
-                        data[idx++] = ori[i * stride[axes[0]]
-                                          + j * stride[axes[1]]
-                                          + k * stride[axes[2]]];
-                    }
-                }
+        // out of place, dst has dimensions dims[axes[0]], ..., dims[axes[N - 1]]
+        void transpose(const T *src, T *dst, const std::array<size_t, N> &dims, const std::array<size_t, N> &axes) {
+            std::array<size_t, N> src_strides, dst_strides;
+            src_strides[N - 1] = 1;
+            for (int d = N - 2; d >= 0; d--) {
+                src_strides[d] = src_strides[d + 1] * dims[d + 1];
             }
-        }
+            // stride in dst of every dimension of src
+            size_t stride = 1;
+            for (int k = N - 1; k >= 0; k--) {
+                dst_strides[axes[k]] = stride;
+                stride *= dims[axes[k]];
+            }
+
+            // a is contiguous in src, b is contiguous in dst
+            const uint a = N - 1, b = axes[N - 1];
+            const size_t tiles_a = a == b ? 1 : (dims[a] + TILE - 1) / TILE;
+            const size_t tiles_b = a == b ? 1 : (dims[b] + TILE - 1) / TILE;
+            size_t groups = tiles_a * tiles_b;
+            for (uint d = 0; d < N; d++) {
+                if (d != a && d != b) groups *= dims[d];
+            }
+            const bool parallel = nThreads > 1 && groups > 1;
 
-        template<uint NN = N>
-        inline typename std::enable_if<NN == 4, void>::type
-        transpose(T *data, std::array<size_t, N> dims, std::array<size_t, N> axes, T *ori,
-                  std::array<size_t, N> stride) {
-            size_t idx = 0;
-            for (size_t i = 0; i < dims[axes[0]]; i++) {
-                for (size_t j = 0; j < dims[axes[1]]; j++) {
-                    for (size_t k = 0; k < dims[axes[2]]; k++) {
-                        for (size_t t = 0; t < dims[axes[3]]; t++) {
-                            data[idx++] = ori[i * stride[axes[0]]
-                                              + j * stride[axes[1]]
-                                              + k * stride[axes[2]]
-                                              + t * stride[axes[3]]];
-                        }
+#pragma omp parallel for schedule(static) num_threads(nThreads) if(parallel)
+            for (ptrdiff_t g = 0; g < (ptrdiff_t) groups; g++) {
+                size_t rest = g;
+                size_t ta = rest % tiles_a;
+                rest /= tiles_a;
+                size_t tb = rest % tiles_b;
+                rest /= tiles_b;
+                size_t src_base = 0, dst_base = 0;
+                for (int d = N - 1; d >= 0; d--) {
+                    if ((uint) d == a || (uint) d == b) continue;
+                    size_t i = rest % dims[d];
+                    rest /= dims[d];
+                    src_base += i * src_strides[d];
+                    dst_base += i * dst_strides[d];
+                }
+                if (a == b) {
+                    memcpy(dst + dst_base, src + src_base, dims[a] * sizeof(T));
+                    continue;
+                }
+                size_t a0 = ta * TILE, a1 = std::min(a0 + TILE, dims[a]);
+                size_t b0 = tb * TILE, b1 = std::min(b0 + TILE, dims[b]);
+                const size_t sb = src_strides[b], da = dst_strides[a];
+                for (size_t j = b0; j < b1; j++) {
+                    const T *s = src + src_base + j * sb;
+                    T *t = dst + dst_base + j;
+                    for (size_t i = a0; i < a1; i++) {
+                        t[i * da] = s[i];
                     }
                 }
             }
         }
 
+    private:
+        static size_t num_elements(const std::array<size_t, N> &dims) {
+            size_t num = 1;
+            for (auto d: dims) {
+                num *= d;
+            }
+            return num;
+        }
 
+        int nThreads;
     };
 }
 #endif //SZ3_TRANSPOSE_H
@@ -1,53 +1,206 @@
 #ifndef SZ3_WAVELET_HPP
 #define SZ3_WAVELET_HPP
 
-#ifdef ENABLE_GSL
+/**
+ * Separable N-D CDF 9/7 wavelet transform by lifting, in place on the data.
+ * Every level transforms the low-pass box of the previous level along each dimension that is at least MIN_LENGTH long,
+ * and stores the low-pass half of every line before its high-pass half (Mallat layout). Lines of any length are
+ * supported with symmetric extension at both ends, so no padding is needed.
+ * Lines along a non-contiguous dimension are transformed in blocks of BLOCK neighbors along the last dimension,
+ * which keeps the memory accesses contiguous and the lifting steps vectorized, and blocks are spread over the threads.
+ */
 
 #include "SZ3/preprocessor/PreProcessor.hpp"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef ENABLE_GSL
 #include <gsl/gsl_wavelet.h>
+#endif
 
 namespace SZ {
     template<class T, uint N>
 
     class Wavelet : public concepts::PreprocessorInterface<T, N> {
     public:
+        static const size_t MIN_LENGTH = 8;
+        static const size_t BLOCK = 32;
+
+        Wavelet(int levels = 6, int nThreads = 1) : levels(levels), nThreads(nThreads) {}
+
+        void preprocess(T *data, std::array<size_t, N> dims) {
+            auto boxes = level_boxes(dims);
+            for (size_t l = 0; l + 1 < boxes.size(); l++) {
+                for (uint d = 0; d < N; d++) {
+                    if (boxes[l + 1][d] != boxes[l][d]) {
+                        transform(data, dims, boxes[l], d, true);
+                    }
+                }
+            }
+        }
+
+        void postProcess(T *data, std::array<size_t, N> dims) {
+            auto boxes = level_boxes(dims);
+            for (size_t l = boxes.size() - 1; l-- > 0;) {
+                for (uint d = N; d-- > 0;) {
+                    if (boxes[l + 1][d] != boxes[l][d]) {
+                        transform(data, dims, boxes[l], d, false);
+                    }
+                }
+            }
+        }
+
+#ifdef ENABLE_GSL
+        // 1D Daubechies-4 transform of the flattened data with GSL, padded to the next power of two
         void preprocess(T *data, size_t n) {
-            size_t m = n - 1;
-            m |= m >> 1;
-            m |= m >> 2;
-            m |= m >> 4;
-            m |= m >> 8;
-            m |= m >> 16;
-            m++;
+            gsl_transform(data, n, true);
+        }
 
-            std::vector<double> dwtdata(m, 0);
-            gsl_wavelet *w;
-            gsl_wavelet_workspace *work;
+        void postProcess(T *data, size_t n) {
+            gsl_transform(data, n, false);
+        }
+#endif
 
-            w = gsl_wavelet_alloc(gsl_wavelet_daubechies, 4);
-            work = gsl_wavelet_workspace_alloc(m);
+    private:
+        // low-pass box of every level, starting with the whole field; the box shrinks along dimensions long enough
+        std::vector<std::array<size_t, N>> level_boxes(const std::array<size_t, N> &dims) const {
+            std::vector<std::array<size_t, N>> boxes{dims};
+            for (int l = 0; l < levels; l++) {
+                auto box = boxes.back();
+                bool split = false;
+                for (uint d = 0; d < N; d++) {
+                    if (box[d] >= MIN_LENGTH) {
+                        box[d] = (box[d] + 1) / 2;
+                        split = true;
+                    }
+                }
+                if (!split) {
+                    break;
+                }
+                boxes.push_back(box);
+            }
+            return boxes;
+        }
+
+        // transform every line along dimension d inside box
+        void transform(T *data, const std::array<size_t, N> &dims, const std::array<size_t, N> &box, uint d,
+                       bool forward) {
+            std::array<size_t, N> strides;
+            strides[N - 1] = 1;
+            for (int i = N - 2; i >= 0; i--) {
+                strides[i] = strides[i + 1] * dims[i + 1];
+            }
+            // lines along d are grouped by BLOCK along the last dimension, unless d is the last dimension
+            size_t width = d == N - 1 ? 1 : box[N - 1];
+            size_t blocks = (width + BLOCK - 1) / BLOCK;
+            size_t groups = blocks;
+            for (uint i = 0; i < N - 1; i++) {
+                if (i != d) groups *= box[i];
+            }
+            const size_t n = box[d], stride = strides[d];
+            const bool parallel = nThreads > 1 && groups > 1;
+
+#pragma omp parallel num_threads(nThreads) if(parallel)
+            {
+                std::vector<double> buffer(n * BLOCK);
+#pragma omp for schedule(static)
+                for (ptrdiff_t g = 0; g < (ptrdiff_t) groups; g++) {
+                    size_t rest = g / blocks;
+                    size_t j0 = (g % blocks) * BLOCK;
+                    size_t B = width - j0 < BLOCK ? width - j0 : BLOCK;
+                    size_t base = d == N - 1 ? 0 : j0;
+                    for (int i = N - 2; i >= 0; i--) {
+                        if ((uint) i == d) continue;
+                        base += (rest % box[i]) * strides[i];
+                        rest /= box[i];
+                    }
+                    if (forward) {
+                        load(data + base, stride, n, B, buffer.data(), false);
+                        forward_lift(buffer.data(), n, B);
+                        store(buffer.data(), n, B, data + base, stride, true);
+                    } else {
+                        load(data + base, stride, n, B, buffer.data(), true);
+                        inverse_lift(buffer.data(), n, B);
+                        store(buffer.data(), n, B, data + base, stride, false);
+                    }
+                }
+            }
+        }
 
+        // copy B lines into buffer[i * B + b], interleaving the low-pass and high-pass halves if they are split
+        static void load(const T *line, size_t stride, size_t n, size_t B, double *buffer, bool split) {
+            size_t half = (n + 1) / 2;
             for (size_t i = 0; i < n; i++) {
-                dwtdata[i] = data[i];
+                size_t k = split ? (i % 2 ? half + i / 2 : i / 2) : i;
+                const T *src = line + k * stride;
+                double *dst = buffer + i * B;
+                for (size_t b = 0; b < B; b++) {
+                    dst[b] = src[b];
+                }
             }
+        }
 
-            int status = gsl_wavelet_transform_forward(w, dwtdata.data(), 1, m, work);
+        static void store(const double *buffer, size_t n, size_t B, T *line, size_t stride, bool split) {
+            size_t half = (n + 1) / 2;
+            for (size_t i = 0; i < n; i++) {
+                size_t k = split ? (i % 2 ? half + i / 2 : i / 2) : i;
+                T *dst = line + k * stride;
+                const double *src = buffer + i * B;
+                for (size_t b = 0; b < B; b++) {
+                    dst[b] = src[b];
+                }
+            }
+        }
 
-            if (status != GSL_SUCCESS) {
-                printf("Error: wavelets transform failed.\n");
-                exit(0);
+        // x[i] += c * (x[i - 1] + x[i + 1]) for i = parity, parity + 2, ..., mirrored at both ends
+        static void lift(double *x, size_t n, size_t B, size_t parity, double c) {
+            for (size_t i = parity; i < n; i += 2) {
+                size_t l = i == 0 ? 1 : i - 1;
+                size_t r = i + 1 == n ? n - 2 : i + 1;
+                double *xi = x + i * B;
+                const double *xl = x + l * B, *xr = x + r * B;
+#pragma omp simd
+                for (size_t b = 0; b < B; b++) {
+                    xi[b] += c * (xl[b] + xr[b]);
+                }
             }
+        }
 
-            for (size_t i = 0; i < n; i++) {
-                data[i] = dwtdata[i];
+        static void scale(double *x, size_t n, size_t B, size_t parity, double c) {
+            for (size_t i = parity; i < n; i += 2) {
+                double *xi = x + i * B;
+#pragma omp simd
+                for (size_t b = 0; b < B; b++) {
+                    xi[b] *= c;
+                }
             }
+        }
 
-            gsl_wavelet_free(w);
-            gsl_wavelet_workspace_free(work);
+        static void forward_lift(double *x, size_t n, size_t B) {
+            lift(x, n, B, 1, ALPHA);
+            lift(x, n, B, 0, BETA);
+            lift(x, n, B, 1, GAMMA);
+            lift(x, n, B, 0, DELTA);
+            scale(x, n, B, 0, K);
+            scale(x, n, B, 1, 1 / K);
+        }
 
+        static void inverse_lift(double *x, size_t n, size_t B) {
+            scale(x, n, B, 0, 1 / K);
+            scale(x, n, B, 1, K);
+            lift(x, n, B, 0, -DELTA);
+            lift(x, n, B, 1, -GAMMA);
+            lift(x, n, B, 0, -BETA);
+            lift(x, n, B, 1, -ALPHA);
         }
 
-        void postProcess(T *data, size_t n) {
+#ifdef ENABLE_GSL
+        static void gsl_transform(T *data, size_t n, bool forward) {
             size_t m = n - 1;
             m |= m >> 1;
             m |= m >> 2;
@@ -57,33 +210,35 @@ namespace SZ {
             m++;
 
             std::vector<double> dwtdata(m, 0);
-            gsl_wavelet *w;
-            gsl_wavelet_workspace *work;
-
-            w = gsl_wavelet_alloc(gsl_wavelet_daubechies, 4);
-            work = gsl_wavelet_workspace_alloc(m);
-
+            gsl_wavelet *w = gsl_wavelet_alloc(gsl_wavelet_daubechies, 4);
+            gsl_wavelet_workspace *work = gsl_wavelet_workspace_alloc(m);
             for (size_t i = 0; i < n; i++) {
                 dwtdata[i] = data[i];
             }
-
-            int status = gsl_wavelet_transform_inverse(w, dwtdata.data(), 1, m, work);
-
+            int status = forward ? gsl_wavelet_transform_forward(w, dwtdata.data(), 1, m, work)
+                                 : gsl_wavelet_transform_inverse(w, dwtdata.data(), 1, m, work);
             if (status != GSL_SUCCESS) {
                 printf("Error: wavelets transform failed.\n");
                 exit(0);
             }
-
             for (size_t i = 0; i < n; i++) {
                 data[i] = dwtdata[i];
             }
-
             gsl_wavelet_free(w);
             gsl_wavelet_workspace_free(work);
-
         }
+#endif
+
+        // lifting coefficients of the CDF 9/7 wavelet, as in JPEG 2000
+        static constexpr double ALPHA = -1.586134342059924;
+        static constexpr double BETA = -0.052980118572961;
+        static constexpr double GAMMA = 0.882911075530934;
+        static constexpr double DELTA = 0.443506852043971;
+        static constexpr double K = 1.149604398860241;
+
+        int levels;
+        int nThreads;
     };
 }
 
-#endif
 #endif //SZ3_WAVELET_HPP
@@ -75,13 +75,16 @@ namespace SZ {
                 T decompressed_data = pred + quant_index * this->error_bound;
                 if (fabs(decompressed_data - data) > this->error_bound) {
                     unpred.push_back(data);
+                    count(0);
                     return 0;
                 } else {
                     data = decompressed_data;
+                    count(quant_index_shifted);
                     return quant_index_shifted;
                 }
             } else {
                 unpred.push_back(data);
+                count(0);
                 return 0;
             }
         }
@@ -104,14 +107,17 @@ namespace SZ {
                 if (fabs(decompressed_data - ori) > this->error_bound) {
                     unpred.push_back(ori);
                     dest = ori;
+                    count(0);
                     return 0;
                 } else {
                     dest = decompressed_data;
+                    count(quant_index_shifted);
                     return quant_index_shifted;
                 }
             } else {
                 unpred.push_back(ori);
                 dest = ori;
+                count(0);
                 return 0;
             }
         }
@@ -138,6 +144,27 @@ namespace SZ {
             return unpred.size() * sizeof(T);
         }
 
+        size_t get_unpred_count() const {
+            return unpred.size();
+        }
+
+        // append the unpredictable data and the histogram of other, which quantized the data that follow
+        void merge(const LinearQuantizer &other) {
+            unpred.insert(unpred.end(), other.unpred.begin(), other.unpred.end());
+            if (histogram.size() == other.histogram.size()) {
+                for (size_t i = 0; i < histogram.size(); i++) {
+                    histogram[i] += other.histogram[i];
+                }
+            }
+        }
+
+        // quantizer that recovers the unpredictable data [begin, begin + count) of this one
+        LinearQuantizer slice(size_t begin, size_t count) const {
+            LinearQuantizer quantizer(error_bound, radius);
+            quantizer.unpred.assign(unpred.begin() + begin, unpred.begin() + begin + count);
+            return quantizer;
+        }
+
         void save(unsigned char *&c) const {
             // std::string serialized(sizeof(uint8_t) + sizeof(T) + sizeof(int),0);
             c[0] = 0b00000010;
@@ -177,9 +204,15 @@ namespace SZ {
 
         void clear() {
             unpred.clear();
+            histogram.clear();
             index = 0;
         }
 
+        // histogram of the indices returned by quantize_and_overwrite since precompress_data(),
+        // empty if precompress_data() was not called
+        const std::vector<size_t> &get_histogram() const {
+            return histogram;
+        }
 
         virtual void postcompress_data() {
         }
@@ -187,13 +220,24 @@ namespace SZ {
         virtual void postdecompress_data() {
         }
 
-        virtual void precompress_data() {};
+        // start collecting the histogram of quantization indices for the encoder
+        virtual void precompress_data() {
+            histogram.assign(2 * radius, 0);
+        };
 
         virtual void predecompress_data() {};
 
 
     private:
+        // NaN input gives indices out of range, they are not counted and the encoder then scans the bins
+        inline void count(int quant_index) {
+            if ((size_t) quant_index < histogram.size()) {
+                histogram[quant_index]++;
+            }
+        }
+
         std::vector<T> unpred;
+        std::vector<size_t> histogram;
         size_t index = 0; // used in decompression only
 
         double error_bound;
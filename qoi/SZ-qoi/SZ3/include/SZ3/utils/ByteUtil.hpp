@@ -6,7 +6,10 @@
 #define SZ3_BYTEUTIL_HPP
 
 #include "SZ3/def.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <type_traits>
 
 namespace SZ {
 
@@ -191,6 +194,57 @@ namespace SZ {
         }
     }
 
+    // values per block of the byte-plane shuffle, the block stays in L1 while its planes are written
+    constexpr size_t SHUFFLE_BLOCK = 4096;
+
+    /**
+     * truncateArray with the kept bytes transposed into byte planes: every block of SHUFFLE_BLOCK values is written as
+     * byteLen planes, the most significant byte of all values first. Signs and exponents then form long runs that the
+     * lossless stage compresses well. The bytes are taken by shifts of the integer value, which vectorizes and works
+     * for float and double.
+     */
+    template<class T>
+    void truncateArrayShuffle(const T *data, size_t n, int byteLen, uchar *&binary) {
+        typedef typename std::conditional<sizeof(T) == 8, uint64_t, uint32_t>::type U;
+        static_assert(sizeof(T) == sizeof(U), "only 4 and 8 byte types are supported");
+        for (size_t start = 0; start < n; start += SHUFFLE_BLOCK) {
+            const size_t len = std::min(SHUFFLE_BLOCK, n - start);
+            const T *block = data + start;
+            for (int b = 0; b < byteLen; b++) {
+                const int shift = 8 * (sizeof(T) - 1 - b);
+                uchar *plane = binary;
+#pragma omp simd
+                for (size_t i = 0; i < len; i++) {
+                    U word;
+                    memcpy(&word, block + i, sizeof(U));
+                    plane[i] = (uchar) (word >> shift);
+                }
+                binary += len;
+            }
+        }
+    }
+
+    // inverse of truncateArrayShuffle, the dropped bytes are zero
+    template<class T>
+    void truncateArrayShuffleRecover(const uchar *binary, size_t n, int byteLen, T *data) {
+        typedef typename std::conditional<sizeof(T) == 8, uint64_t, uint32_t>::type U;
+        static_assert(sizeof(T) == sizeof(U), "only 4 and 8 byte types are supported");
+        U words[SHUFFLE_BLOCK];
+        for (size_t start = 0; start < n; start += SHUFFLE_BLOCK) {
+            const size_t len = std::min(SHUFFLE_BLOCK, n - start);
+            std::fill_n(words, len, 0);
+            for (int b = 0; b < byteLen; b++) {
+                const int shift = 8 * (sizeof(T) - 1 - b);
+#pragma omp simd
+                for (size_t i = 0; i < len; i++) {
+                    words[i] |= (U) binary[i] << shift;
+                }
+                binary += len;
+            }
+            memcpy(data + start, words, len * sizeof(T));
+        }
+    }
+
     std::vector<uchar> LeadingBitsEncode(float pre, float data) {
         lfloat lfBuf_pre;
         lfloat lfBuf_cur;
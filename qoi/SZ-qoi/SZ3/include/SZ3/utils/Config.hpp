@@ -15,14 +15,15 @@
 namespace SZ {
 
     enum EB {
-        EB_ABS, EB_REL, EB_PSNR, EB_L2NORM, EB_ABS_AND_REL, EB_ABS_OR_REL
+        EB_ABS, EB_REL, EB_PSNR, EB_L2NORM, EB_ABS_AND_REL, EB_ABS_OR_REL, EB_RATIO
     };
-    const char *EB_STR[] = {"ABS", "REL", "PSNR", "NORM", "ABS_AND_REL", "ABS_OR_REL"};
+    const char *EB_STR[] = {"ABS", "REL", "PSNR", "NORM", "ABS_AND_REL", "ABS_OR_REL", "RATIO"};
 
     enum ALGO {
-        ALGO_LORENZO_REG, ALGO_INTERP_LORENZO, ALGO_INTERP
+        ALGO_LORENZO_REG, ALGO_INTERP_LORENZO, ALGO_INTERP, ALGO_LORENZO_DUALQUANT, ALGO_TEMPORAL, ALGO_WAVELET
     };
-    const char *ALGO_STR[] = {"ALGO_LORENZO_REG", "ALGO_INTERP_LORENZO", "ALGO_INTERP"};
+    const char *ALGO_STR[] = {"ALGO_LORENZO_REG", "ALGO_INTERP_LORENZO", "ALGO_INTERP", "ALGO_LORENZO_DUALQUANT",
+                              "ALGO_TEMPORAL", "ALGO_WAVELET"};
 
     enum INTERP_ALGO {
         INTERP_ALGO_LINEAR, INTERP_ALGO_CUBIC
@@ -43,6 +44,28 @@ namespace SZ {
         }
     }
 
+    // statistics of the input field, see SZ::get_data_stats()
+    struct DataStats {
+        bool valid = false;
+        const void *data = nullptr; // the field the statistics belong to
+        size_t num = 0;
+        double min = 0;             // min, max, mean and variance only count finite values
+        double max = 0;
+        double range = 0;           // max - min, evaluated in the data type
+        double mean = 0;
+        double variance = 0;
+        size_t zeroCount = 0;
+        size_t nanCount = 0;
+        size_t infCount = 0;
+    };
+
+    // reconstructed field of the previous timestep for ALGO_TEMPORAL, see SZ::TemporalContext
+    struct TemporalRef {
+        const void *data = nullptr; // nullptr -> the current step is a key frame
+        size_t num = 0;
+        size_t step = 0;            // index of the current step in the sequence
+    };
+
     class Config {
     public:
         template<class ... Dims>
@@ -80,6 +103,12 @@ namespace SZ {
                 cmprAlgo = ALGO_INTERP_LORENZO;
             } else if (cmprAlgoStr == ALGO_STR[ALGO_INTERP]) {
                 cmprAlgo = ALGO_INTERP;
+            } else if (cmprAlgoStr == ALGO_STR[ALGO_LORENZO_DUALQUANT]) {
+                cmprAlgo = ALGO_LORENZO_DUALQUANT;
+            } else if (cmprAlgoStr == ALGO_STR[ALGO_TEMPORAL]) {
+                cmprAlgo = ALGO_TEMPORAL;
+            } else if (cmprAlgoStr == ALGO_STR[ALGO_WAVELET]) {
+                cmprAlgo = ALGO_WAVELET;
             }
             auto ebModeStr = cfg.Get("GlobalSettings", "ErrorBoundMode", "");
             if (ebModeStr == EB_STR[EB_ABS]) {
@@ -94,11 +123,21 @@ namespace SZ {
                 errorBoundMode = EB_ABS_AND_REL;
             } else if (ebModeStr == EB_STR[EB_ABS_OR_REL]) {
                 errorBoundMode = EB_ABS_OR_REL;
+            } else if (ebModeStr == EB_STR[EB_RATIO]) {
+                errorBoundMode = EB_RATIO;
             }
             absErrorBound = cfg.GetReal("GlobalSettings", "AbsErrorBound", absErrorBound);
             relErrorBound = cfg.GetReal("GlobalSettings", "RelErrorBound", relErrorBound);
             psnrErrorBound = cfg.GetReal("GlobalSettings", "PSNRErrorBound", psnrErrorBound);
             l2normErrorBound = cfg.GetReal("GlobalSettings", "L2NormErrorBound", l2normErrorBound);
+            targetRatio = cfg.GetReal("GlobalSettings", "TargetRatio", targetRatio);
+            ratioTolerance = cfg.GetReal("GlobalSettings", "RatioTolerance", ratioTolerance);
+            ratioCorrection = cfg.GetBoolean("GlobalSettings", "RatioCorrection", ratioCorrection);
+            timeBudget = cfg.GetReal("GlobalSettings", "TimeBudget", timeBudget);
+            targetThroughput = cfg.GetReal("GlobalSettings", "TargetThroughput", targetThroughput);
+            losslessLevel = cfg.GetInteger("GlobalSettings", "LosslessLevel", losslessLevel);
+            autoAxes = cfg.GetBoolean("GlobalSettings", "AutoAxes", autoAxes);
+            preserveTileElements = cfg.GetInteger("GlobalSettings", "PreserveTileElements", preserveTileElements);
 
             openmp = cfg.GetBoolean("GlobalSettings", "OpenMP", openmp);
             lorenzo = cfg.GetBoolean("AlgoSettings", "Lorenzo", lorenzo);
@@ -163,6 +202,11 @@ namespace SZ {
             write(qoiEBs.data(), qoiEBs.size(), c);
         };
 
+        // upper bound of the number of bytes written by save()
+        size_t size_est() const {
+            return 256 + sizeof(size_t) * dims.size() + sizeof(double) * (isovalues.size() + qoiEBs.size());
+        }
+
         void load(const unsigned char *&c) {
             read(N, c);
             dims.resize(N);
@@ -214,6 +258,24 @@ namespace SZ {
         double relErrorBound;
         double psnrErrorBound;
         double l2normErrorBound;
+        // EB_RATIO resolves absErrorBound for this compression ratio, within a relative tolerance; not serialized
+        double targetRatio = 0;
+        double ratioTolerance = 0.05;
+        bool ratioCorrection = true; // check the ratio on the whole field and compress again if it is off
+        // deadline mode picks the algorithm, tuning and lossless level to compress in timeBudget seconds
+        // or at targetThroughput GB/s (0 -> off), see SZ3/api/impl/SZDeadline.hpp; not serialized
+        double timeBudget = 0;
+        double targetThroughput = 0;
+        int losslessLevel = 3; // zstd level, only the compressor needs it
+        // compress the field with the axis order that compresses its sample best, see SZ3/api/impl/SZAxes.hpp
+        bool autoAxes = false;
+        // dimension k of the compressed field is dimension axes[k] of the input, empty if unchanged;
+        // stored in the container header, not by save()
+        std::vector<uint8_t> axes;
+        // SZ_compress on read-only data copies the field tile by tile; 0 -> the tiles of the in-place path, so the
+        // output is the same. Tiles of at most this many elements bound the extra memory, but every tile boundary
+        // costs ratio (1-4% with 1 << 22 elements on 256^3 fields); not serialized
+        size_t preserveTileElements = 0;
         bool lorenzo = true;
         bool lorenzo2 = false;
         bool regression = true;
@@ -238,6 +300,9 @@ namespace SZ {
         std::vector<double> isovalues;
         int qoiNum = 0;
         std::vector<double> qoiEBs;
+        DataStats dataStats; // cached per compression call, not serialized
+        TemporalRef temporal; // set by the TemporalContext API per call, not serialized
+        int nThreads = 0; // OpenMP threads of this process, 0 -> OpenMP default; not serialized, so the reader decides
     };
 
 
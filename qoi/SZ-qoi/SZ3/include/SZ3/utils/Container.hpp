@@ -0,0 +1,244 @@
+#ifndef SZ3_CONTAINER_HPP
+#define SZ3_CONTAINER_HPP
+
+/**
+ * Indexed container of SZ3 compressed data.
+ * The header comes first so that a reader can locate, check and decompress every chunk independently.
+ *
+ * header:
+ *   magic (8 bytes), version (uint32), header size (uint64, bytes before the payload)
+ *   Config of the whole field
+ *   axis order (uint8 count, then uint8 x count, since version 3), see Config::axes
+ *   chunk count (uint64)
+ *   chunk table, for each chunk:
+ *     offset and size in the payload (uint64 x2), size of the chunk Config (uint64),
+ *     first index along dims[0] (uint64), algorithm (uint8), N (uint8), dims (uint64 x N),
+ *     first index along dims[1..N-1] (uint64 x (N-1), since version 2), xxhash64 of the chunk
+ *   xxhash64 of all header bytes above
+ * payload:
+ *   chunks, each holds its own Config followed by the compressed data
+ * A chunk is a slab along dims[0] or, since version 2, a tile of the field.
+ */
+
+#include "SZ3/def.hpp"
+#include "SZ3/utils/Config.hpp"
+#include "SZ3/utils/MemoryUtil.hpp"
+#include "SZ3/utils/Profiler.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define XXH_PRIVATE_API
+#include "xxhash.h"
+
+namespace SZ {
+
+    constexpr char CONTAINER_MAGIC[8] = {'S', 'Z', '3', 'C', 'O', 'N', 'T', '\0'};
+    constexpr uint32_t CONTAINER_VERSION = 3;
+
+    struct ContainerChunk {
+        size_t offset = 0;      // in the payload
+        size_t size = 0;        // including the chunk Config
+        size_t confSize = 0;
+        size_t start = 0;       // first index along dims[0]
+        uint8_t cmprAlgo = 0;
+        std::vector<size_t> dims;
+        std::vector<size_t> starts; // first index along every dimension, starts[0] == start
+        uint64_t checksum = 0;
+    };
+
+    inline uint64_t container_checksum(const void *data, size_t len) {
+        return XXH64(data, len, 0);
+    }
+
+    /**
+     * Pack independently compressed chunks into a container
+     * @param conf config of the whole field
+     * @param chunk_conf config used to compress each chunk
+     * @param chunk_starts first index of each chunk along every dimension
+     * @param chunk_data compressed data of each chunk
+     * @param chunk_size compressed size of each chunk
+     * @param outSize container size in bytes
+     * @return the container, remember to 'delete []' when the data is no longer needed.
+     */
+    inline char *container_write(Config &conf, std::vector<Config> &chunk_conf,
+                                 const std::vector<std::vector<size_t>> &chunk_starts,
+                                 const std::vector<char *> &chunk_data, const std::vector<size_t> &chunk_size,
+                                 size_t &outSize) {
+        ProfileScope scope(STAGE_CONFIG);
+        size_t chunk_num = chunk_conf.size();
+        std::vector<ContainerChunk> chunks(chunk_num);
+        std::vector<std::vector<uchar>> chunk_conf_bytes(chunk_num);
+        size_t payload_size = 0;
+        size_t header_est = sizeof(CONTAINER_MAGIC) + sizeof(uint32_t) + 3 * sizeof(uint64_t) + conf.size_est()
+                            + 1 + conf.axes.size();
+        for (size_t i = 0; i < chunk_num; i++) {
+            auto &bytes = chunk_conf_bytes[i];
+            bytes.resize(chunk_conf[i].size_est());
+            uchar *pos = bytes.data();
+            chunk_conf[i].save(pos);
+            bytes.resize(pos - bytes.data());
+
+            auto &c = chunks[i];
+            c.offset = payload_size;
+            c.confSize = bytes.size();
+            c.size = c.confSize + chunk_size[i];
+            scope.add_bytes_in(chunk_size[i]);
+            c.starts = chunk_starts[i];
+            c.start = c.starts[0];
+            c.cmprAlgo = chunk_conf[i].cmprAlgo;
+            c.dims = chunk_conf[i].dims;
+            payload_size += c.size;
+            header_est += 5 * sizeof(uint64_t) + 2 * sizeof(uint8_t) + 2 * c.dims.size() * sizeof(uint64_t);
+        }
+
+        std::vector<uchar> header(header_est);
+        uchar *header_end = header.data();
+        // the checksums are only known after the payload is written, fill the header in two passes
+        auto write_header = [&]() {
+            uchar *pos = header.data();
+            write(CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC), pos);
+            write(CONTAINER_VERSION, pos);
+            uchar *header_size_pos = pos;
+            write((uint64_t) 0, pos);
+            conf.save(pos);
+            write((uint8_t) conf.axes.size(), pos);
+            write(conf.axes.data(), conf.axes.size(), pos);
+            write((uint64_t) chunk_num, pos);
+            for (const auto &c: chunks) {
+                write((uint64_t) c.offset, pos);
+                write((uint64_t) c.size, pos);
+                write((uint64_t) c.confSize, pos);
+                write((uint64_t) c.start, pos);
+                write(c.cmprAlgo, pos);
+                write((uint8_t) c.dims.size(), pos);
+                for (auto d: c.dims) {
+                    write((uint64_t) d, pos);
+                }
+                for (size_t d = 1; d < c.dims.size(); d++) {
+                    write((uint64_t) c.starts[d], pos);
+                }
+                write(c.checksum, pos);
+            }
+            uint64_t header_size = pos - header.data() + sizeof(uint64_t);
+            write(header_size, header_size_pos);
+            write(container_checksum(header.data(), pos - header.data()), pos);
+            header_end = pos;
+        };
+        write_header();
+        size_t header_size = header_end - header.data();
+
+        outSize = header_size + payload_size;
+        char *container = new char[outSize];
+        char *payload = container + header_size;
+#pragma omp parallel for schedule(dynamic)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t) chunk_num; i++) {
+            auto &c = chunks[i];
+            memcpy(payload + c.offset, chunk_conf_bytes[i].data(), c.confSize);
+            memcpy(payload + c.offset + c.confSize, chunk_data[i], chunk_size[i]);
+            c.checksum = container_checksum(payload + c.offset, c.size);
+        }
+        write_header();
+        memcpy(container, header.data(), header_size);
+        scope.add_bytes_out(outSize);
+        return container;
+    }
+
+    // chunks that are slabs along dims[0], chunk_start is the first index of each chunk along dims[0]
+    inline char *container_write(Config &conf, std::vector<Config> &chunk_conf, const std::vector<size_t> &chunk_start,
+                                 const std::vector<char *> &chunk_data, const std::vector<size_t> &chunk_size,
+                                 size_t &outSize) {
+        std::vector<std::vector<size_t>> chunk_starts(chunk_start.size(), std::vector<size_t>(conf.N, 0));
+        for (size_t i = 0; i < chunk_start.size(); i++) {
+            chunk_starts[i][0] = chunk_start[i];
+        }
+        return container_write(conf, chunk_conf, chunk_starts, chunk_data, chunk_size, outSize);
+    }
+
+    // whether the data start with a container header, data written before the container format do not
+    inline bool container_check(const char *data, size_t size) {
+        return size >= sizeof(CONTAINER_MAGIC) && memcmp(data, CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC)) == 0;
+    }
+
+    /**
+     * Parse and check the container header, the data should have passed container_check()
+     * @param conf loaded with the config of the whole field
+     * @param chunks loaded with the chunk table
+     * @return offset of the payload
+     */
+    inline size_t container_read(const char *data, size_t size, Config &conf, std::vector<ContainerChunk> &chunks) {
+        ProfileScope scope(STAGE_CONFIG);
+        const uchar *pos = (const uchar *) data + sizeof(CONTAINER_MAGIC);
+        uint32_t version;
+        uint64_t header_size, chunk_num, checksum;
+        size_t min_size = sizeof(CONTAINER_MAGIC) + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        if (size < min_size) {
+            printf("Error, the compressed data are truncated\n");
+            exit(0);
+        }
+        read(version, pos);
+        read(header_size, pos);
+        if (header_size < min_size || header_size > size) {
+            printf("Error, the compressed data are truncated or corrupted\n");
+            exit(0);
+        }
+        memcpy(&checksum, data + header_size - sizeof(uint64_t), sizeof(uint64_t));
+        if (checksum != container_checksum(data, header_size - sizeof(uint64_t))) {
+            printf("Error, checksum mismatch in the header, the compressed data are corrupted\n");
+            exit(0);
+        }
+        if (version > CONTAINER_VERSION) {
+            printf("Error, container version %u is not supported\n", version);
+            exit(0);
+        }
+        conf.load(pos);
+        conf.axes.clear();
+        if (version >= 3) {
+            uint8_t n;
+            read(n, pos);
+            conf.axes.resize(n);
+            read(conf.axes.data(), n, pos);
+        }
+        read(chunk_num, pos);
+        chunks.resize(chunk_num);
+        for (auto &c: chunks) {
+            uint64_t v;
+            uint8_t n;
+            read(v, pos);
+            c.offset = v;
+            read(v, pos);
+            c.size = v;
+            read(v, pos);
+            c.confSize = v;
+            read(v, pos);
+            c.start = v;
+            read(c.cmprAlgo, pos);
+            read(n, pos);
+            c.dims.resize(n);
+            for (auto &d: c.dims) {
+                read(v, pos);
+                d = v;
+            }
+            c.starts.assign(n, 0);
+            c.starts[0] = c.start;
+            for (size_t d = 1; d < n && version >= 2; d++) {
+                read(v, pos);
+                c.starts[d] = v;
+            }
+            read(c.checksum, pos);
+            if (c.offset + c.size > size - header_size) {
+                printf("Error, chunk exceeds the compressed data, the data may be truncated\n");
+                exit(0);
+            }
+        }
+        scope.add_bytes_in(header_size);
+        return header_size;
+    }
+
+    // compare the chunk with its checksum in the chunk table
+    inline bool container_verify_chunk(const char *payload, const ContainerChunk &chunk) {
+        return container_checksum(payload + chunk.offset, chunk.size) == chunk.checksum;
+    }
+}
+
+#endif
@@ -5,6 +5,15 @@
 #ifndef SZ_EXTRACTION_HPP
 #define SZ_EXTRACTION_HPP
 
+#include "SZ3/def.hpp"
+#include "SZ3/utils/Profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <vector>
 
 namespace SZ {
 
@@ -17,17 +26,35 @@ namespace SZ {
         return sample_n * 1.0 / n;
     }
 
+    /**
+     * Zero-copy description of the sampled sub-field used for tuning.
+     * The data are split into dmin^N blocks, and 2 * sampling_block layers around the center of every block
+     * are taken along each dimension. Along the last dimension the samples of a row are a few contiguous runs,
+     * so the sub-field is gathered row by row with memcpy.
+     * If the sampling block is too small, the view covers the whole field.
+     */
+    template<class T, uint N>
+    struct SamplingView {
+        const T *data;
+        std::vector<size_t> dims;
+        std::vector<size_t> sample_dims;
+        size_t sample_num;
+        size_t sampling_block;
+        bool full;                                          // the view is the whole field
+        std::array<std::vector<size_t>, N> src_index;       // original index of the i-th sample along each dimension
+        std::vector<std::pair<size_t, size_t>> row_runs;    // contiguous (original offset, length) runs of a row
+    };
 
     template<class T, uint N>
-    inline typename std::enable_if<N == 4, std::vector<T>>::type
-    sampling(T *data, std::vector<size_t> dims, size_t &sample_num, std::vector<size_t> &sample_dims, size_t &sampling_block) {
+    SamplingView<T, N> make_sampling_view(const T *data, const std::vector<size_t> &dims) {
         assert(dims.size() == N);
-        assert(sample_dims.size() == N);
-        SZ::Timer timer(true);
+        SamplingView<T, N> view;
+        view.data = data;
+        view.dims = dims;
         size_t num = std::accumulate(dims.begin(), dims.end(), (size_t) 1, std::multiplies<>());
 
         size_t dmin = *std::min_element(dims.begin(), dims.end());
-        sampling_block = dmin;
+        size_t sampling_block = dmin;
         while (cal_sampling_ratio<N>(sampling_block, num, dmin, dims) > 0.035) {
             sampling_block--;
         }
@@ -35,207 +62,101 @@ namespace SZ {
             sampling_block = dmin / 2;
         }
         if (sampling_block < 9) {
-            sample_dims = dims;
-            sampling_block = dmin;
-            sample_num = num;
-            std::vector<T> sampling_data(data, data + num);
-            return sampling_data;
-        }
-        size_t b0 = dims[0] / dmin;
-        size_t b1 = dims[1] / dmin;
-        size_t b2 = dims[2] / dmin;
-        size_t b3 = dims[3] / dmin;
-        sample_dims[0] = b0 * 2 * sampling_block;
-        sample_dims[1] = b1 * 2 * sampling_block;
-        sample_dims[2] = b2 * 2 * sampling_block;
-        sample_dims[3] = b3 * 2 * sampling_block;
-        size_t di, dj, dk, dt;
-        sample_num = sample_dims[0] * sample_dims[1] * sample_dims[2] * sample_dims[3];
-        std::vector<T> sampling_data(sample_num, 0);
-
-        for (size_t bi = 0; bi < b0; bi++) {
-            for (size_t bj = 0; bj < b1; bj++) {
-                for (size_t bk = 0; bk < b2; bk++) {
-                    for (size_t bt = 0; bt < b3; bt++) {
-                        for (size_t i = 0; i < 2 * sampling_block; i++) {
-                            for (size_t j = 0; j < 2 * sampling_block; j++) {
-                                for (size_t k = 0; k < 2 * sampling_block; k++) {
-                                    for (size_t t = 0; t < 2 * sampling_block; t++) {
-                                        di = i < sampling_block ? i + sampling_block : dmin - 3 * sampling_block + i;
-                                        dj = j < sampling_block ? j + sampling_block : dmin - 3 * sampling_block + j;
-                                        dk = k < sampling_block ? k + sampling_block : dmin - 3 * sampling_block + k;
-                                        dt = t < sampling_block ? t + sampling_block : dmin - 3 * sampling_block + t;
-                                        size_t idx = (bi * dmin + di) * dims[1] * dims[2] * dims[3]
-                                                     + (bj * dmin + dj) * dims[2] * dims[3]
-                                                     + (bk * dmin + dk) * dims[3]
-                                                     + bt * dmin + dt;
-                                        sampling_data[(bi * 2 * sampling_block + i) * sample_dims[1] * sample_dims[2] * sample_dims[3]
-                                                      + (bj * 2 * sampling_block + j) * sample_dims[1] * sample_dims[2]
-                                                      + (bk * 2 * sampling_block + k) * sample_dims[2]
-                                                      + bt * 2 * sampling_block + t] = data[idx];
-                                    }
-                                }
-                            }
-                        }
-                    }
+            view.full = true;
+            view.sample_dims = dims;
+            view.sampling_block = dmin;
+            view.sample_num = num;
+            return view;
+        }
+        view.full = false;
+        view.sampling_block = sampling_block;
+        view.sample_dims.resize(N);
+        view.sample_num = 1;
+        for (uint d = 0; d < N; d++) {
+            size_t blocks = dims[d] / dmin;
+            view.sample_dims[d] = blocks * 2 * sampling_block;
+            view.sample_num *= view.sample_dims[d];
+            view.src_index[d].resize(view.sample_dims[d]);
+            for (size_t b = 0; b < blocks; b++) {
+                for (size_t i = 0; i < 2 * sampling_block; i++) {
+                    size_t di = i < sampling_block ? i + sampling_block : dmin - 3 * sampling_block + i;
+                    view.src_index[d][b * 2 * sampling_block + i] = b * dmin + di;
                 }
             }
-
         }
-//        auto sampling_time = timer.stop();
-//        printf("Generate sampling data, block = %lu percent = %.3f%% Time = %.3f \n", sampling_block, sample_num * 100.0 / num,
-//               sampling_time);
-        return sampling_data;
+        const auto &last = view.src_index[N - 1];
+        for (size_t i = 0; i < last.size(); i++) {
+            if (!view.row_runs.empty() && view.row_runs.back().first + view.row_runs.back().second == last[i]) {
+                view.row_runs.back().second++;
+            } else {
+                view.row_runs.emplace_back(last[i], 1);
+            }
+        }
+        return view;
     }
 
-
+    // copy the samples of the view into dst (view.sample_num elements) in parallel
     template<class T, uint N>
-    inline typename std::enable_if<N == 3, std::vector<T>>::type
-    sampling(T *data, std::vector<size_t> dims, size_t &sample_num, std::vector<size_t> &sample_dims, size_t &sampling_block) {
-        assert(dims.size() == N);
-        assert(sample_dims.size() == N);
-        size_t num = std::accumulate(dims.begin(), dims.end(), (size_t) 1, std::multiplies<>());
-
-        size_t dmin = *std::min_element(dims.begin(), dims.end());
-        sampling_block = dmin;
-        while (cal_sampling_ratio<N>(sampling_block, num, dmin, dims) > 0.035) {
-            sampling_block--;
-        }
-        if (sampling_block * 2 > dmin) {
-            sampling_block = dmin / 2;
-        }
-        if (sampling_block < 9) {
-            sample_dims = dims;
-            sampling_block = dmin;
-            sample_num = num;
-            std::vector<T> sampling_data(data, data + num);
-            return sampling_data;
-        }
-        size_t b0 = dims[0] / dmin;
-        size_t b1 = dims[1] / dmin;
-        size_t b2 = dims[2] / dmin;
-        sample_dims[0] = b0 * 2 * sampling_block;
-        sample_dims[1] = b1 * 2 * sampling_block;
-        sample_dims[2] = b2 * 2 * sampling_block;
-        size_t di, dj, dk;
-        sample_num = sample_dims[0] * sample_dims[1] * sample_dims[2];
-        std::vector<T> sampling_data(sample_num, 0);
-
-        for (size_t bi = 0; bi < b0; bi++) {
-            for (size_t bj = 0; bj < b1; bj++) {
-                for (size_t bk = 0; bk < b2; bk++) {
-                    for (size_t i = 0; i < 2 * sampling_block; i++) {
-                        for (size_t j = 0; j < 2 * sampling_block; j++) {
-                            for (size_t k = 0; k < 2 * sampling_block; k++) {
-                                di = i < sampling_block ? i + sampling_block : dmin - 3 * sampling_block + i;
-                                dj = j < sampling_block ? j + sampling_block : dmin - 3 * sampling_block + j;
-                                dk = k < sampling_block ? k + sampling_block : dmin - 3 * sampling_block + k;
-                                auto d = data[(bi * dmin + di) * dims[1] * dims[2] + (bj * dmin + dj) * dims[2] +
-                                              bk * dmin + dk];
-                                sampling_data[(bi * 2 * sampling_block + i) * sample_dims[1] * sample_dims[2]
-                                              + (bj * 2 * sampling_block + j) * sample_dims[2]
-                                              + bk * 2 * sampling_block + k] = d;
-                            }
-                        }
-                    }
-                }
+    void sampling_gather(const SamplingView<T, N> &view, T *dst) {
+        ProfileScope scope(STAGE_SAMPLING, view.sample_num * sizeof(T));
+        scope.add_bytes_out(view.sample_num * sizeof(T));
+        if (view.full) {
+            const size_t chunk = 1 << 20;
+            const ptrdiff_t chunk_num = (view.sample_num + chunk - 1) / chunk;
+#pragma omp parallel for schedule(static)
+            for (ptrdiff_t c = 0; c < chunk_num; c++) {
+                size_t begin = c * chunk;
+                size_t len = std::min(chunk, view.sample_num - begin);
+                memcpy(dst + begin, view.data + begin, len * sizeof(T));
+            }
+            return;
+        }
+        std::array<size_t, N> strides;
+        size_t stride = 1;
+        for (int d = N - 1; d >= 0; d--) {
+            strides[d] = stride;
+            stride *= view.dims[d];
+        }
+        const size_t row_len = view.sample_dims[N - 1];
+        const ptrdiff_t rows = view.sample_num / row_len;
+#pragma omp parallel for schedule(static)
+        for (ptrdiff_t r = 0; r < rows; r++) {
+            size_t offset = 0;
+            size_t rest = r;
+            for (int d = N - 2; d >= 0; d--) {
+                offset += view.src_index[d][rest % view.sample_dims[d]] * strides[d];
+                rest /= view.sample_dims[d];
+            }
+            T *out = dst + r * row_len;
+            for (const auto &run: view.row_runs) {
+                memcpy(out, view.data + offset + run.first, run.second * sizeof(T));
+                out += run.second;
             }
         }
-//        auto sampling_time = timer.stop();
-//        printf("Generate sampling data, block = %lu percent = %.3f%% Time = %.3f \n", sampling_block, sample_num * 100.0 / num,
-//               sampling_time);
-        return sampling_data;
     }
 
+    // the samples of the view in one array: the data themselves if the view covers them, else gathered into buffer
     template<class T, uint N>
-    inline typename std::enable_if<N == 2, std::vector<T>>::type
-    sampling(T *data, std::vector<size_t> dims, size_t &sample_num, std::vector<size_t> &sample_dims, size_t &sampling_block) {
-        assert(dims.size() == N);
-        assert(sample_dims.size() == N);
-        SZ::Timer timer(true);
-        size_t num = std::accumulate(dims.begin(), dims.end(), (size_t) 1, std::multiplies<>());
-
-        size_t dmin = *std::min_element(dims.begin(), dims.end());
-        sampling_block = dmin;
-        while (cal_sampling_ratio<N>(sampling_block, num, dmin, dims) > 0.035) {
-            sampling_block--;
-        }
-        if (sampling_block * 2 > dmin) {
-            sampling_block = dmin / 2;
-        }
-        if (sampling_block < 9) {
-            sample_dims = dims;
-            sampling_block = dmin;
-            sample_num = num;
-            std::vector<T> sampling_data(data, data + num);
-            return sampling_data;
-        }
-        size_t b0 = dims[0] / dmin;
-        size_t b1 = dims[1] / dmin;
-        sample_dims[0] = b0 * 2 * sampling_block;
-        sample_dims[1] = b1 * 2 * sampling_block;
-        size_t di, dj;
-        sample_num = sample_dims[0] * sample_dims[1];
-        std::vector<T> sampling_data(sample_num, 0);
-
-        for (size_t bi = 0; bi < b0; bi++) {
-            for (size_t bj = 0; bj < b1; bj++) {
-                for (size_t i = 0; i < 2 * sampling_block; i++) {
-                    for (size_t j = 0; j < 2 * sampling_block; j++) {
-                        di = i < sampling_block ? i + sampling_block : dmin - 3 * sampling_block + i;
-                        dj = j < sampling_block ? j + sampling_block : dmin - 3 * sampling_block + j;
-                        auto d = data[(bi * dmin + di) * dims[1] + bj * dmin + dj];
-                        sampling_data[(bi * 2 * sampling_block + i) * sample_dims[1]
-                                      + bj * 2 * sampling_block + j] = d;
-                    }
-                }
-            }
+    const T *sampling_source(const SamplingView<T, N> &view, std::vector<T> &buffer) {
+        if (view.full) {
+            return view.data;
         }
-//        auto sampling_time = timer.stop();
-//        printf("Generate sampling data, block = %lu percent = %.3f%% Time = %.3f \n", sampling_block, sample_num * 100.0 / num,
-//               sampling_time);
-        return sampling_data;
+        buffer.resize(view.sample_num);
+        sampling_gather(view, buffer.data());
+        return buffer.data();
     }
 
+    // gather the sampled sub-field into a new buffer; compressors overwrite their input, so tuning runs on this copy
     template<class T, uint N>
-    inline typename std::enable_if<N == 1, std::vector<T>>::type
+    std::vector<T>
     sampling(T *data, std::vector<size_t> dims, size_t &sample_num, std::vector<size_t> &sample_dims, size_t &sampling_block) {
-        assert(dims.size() == N);
         assert(sample_dims.size() == N);
-        SZ::Timer timer(true);
-        size_t num = std::accumulate(dims.begin(), dims.end(), (size_t) 1, std::multiplies<>());
-
-        size_t dmin = *std::min_element(dims.begin(), dims.end());
-        sampling_block = dmin;
-        while (cal_sampling_ratio<N>(sampling_block, num, dmin, dims) > 0.035) {
-            sampling_block--;
-        }
-        if (sampling_block * 2 > dmin) {
-            sampling_block = dmin / 2;
-        }
-        if (sampling_block < 9) {
-            sample_dims = dims;
-            sampling_block = dmin;
-            sample_num = num;
-            std::vector<T> sampling_data(data, data + num);
-            return sampling_data;
-        }
-        size_t b0 = dims[0] / dmin;
-        sample_dims[0] = b0 * 2 * sampling_block;
-        size_t di;
-        sample_num = sample_dims[0];
-        std::vector<T> sampling_data(sample_num, 0);
-
-        for (size_t bi = 0; bi < b0; bi++) {
-            for (size_t i = 0; i < 2 * sampling_block; i++) {
-                di = i < sampling_block ? i + sampling_block : dmin - 3 * sampling_block + i;
-                auto d = data[bi * dmin + di];
-                sampling_data[bi * 2 * sampling_block + i] = d;
-            }
-        }
-//        auto sampling_time = timer.stop();
-//        printf("Generate sampling data, block = %lu percent = %.3f%% Time = %.3f \n", sampling_block, sample_num * 100.0 / num,
-//               sampling_time);
+        auto view = make_sampling_view<T, N>(data, dims);
+        sample_num = view.sample_num;
+        sample_dims = view.sample_dims;
+        sampling_block = view.sampling_block;
+        std::vector<T> sampling_data(sample_num);
+        sampling_gather(view, sampling_data.data());
         return sampling_data;
     }
 };
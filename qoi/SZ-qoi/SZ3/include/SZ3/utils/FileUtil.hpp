@@ -9,8 +9,21 @@
 #include <fstream>
 #include <iomanip>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
 #include <random>
 #include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SZ_POSIX_IO 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace SZ {
 
@@ -23,9 +36,13 @@ namespace SZ {
         }
         fin.seekg(0, std::ios::end);
         const size_t num_elements = fin.tellg() / sizeof(Type);
-        assert(num_elements == num && "File size is not equals to the input setting");
+        // data may be sized by num (e.g. FilePrefetcher), never read past it
+        if (num_elements != num) {
+            std::cout << " Error, file size of " << file << " is not equal to the input setting" << std::endl;
+            exit(0);
+        }
         fin.seekg(0, std::ios::beg);
-        fin.read(reinterpret_cast<char *>(data), num_elements * sizeof(Type));
+        fin.read(reinterpret_cast<char *>(data), num * sizeof(Type));
         fin.close();
     }
 
@@ -54,6 +71,190 @@ namespace SZ {
         fout.close();
     }
 
+    // alignment of buffers and offsets for O_DIRECT reads
+    constexpr size_t IO_ALIGNMENT = 4096;
+
+    struct AlignedDeleter {
+        void operator()(void *p) const { free(p); }
+    };
+
+    template<typename Type>
+    using AlignedBuffer = std::unique_ptr<Type[], AlignedDeleter>;
+
+    // buffer that can be filled by readfile_direct() without a bounce buffer
+    template<typename Type>
+    AlignedBuffer<Type> aligned_buffer(size_t num) {
+        size_t bytes = (num * sizeof(Type) + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT;
+        auto data = static_cast<Type *>(aligned_alloc(IO_ALIGNMENT, bytes == 0 ? IO_ALIGNMENT : bytes));
+        if (data == nullptr) {
+            std::cout << "Error, unable to allocate " << bytes << " bytes" << std::endl;
+            exit(0);
+        }
+        return AlignedBuffer<Type>(data);
+    }
+
+    /**
+     * Read a file with O_DIRECT, so that large inputs which are read only once bypass the page cache.
+     * The aligned part of the file is read directly into data if data is aligned to IO_ALIGNMENT
+     * (see aligned_buffer), otherwise through an aligned bounce buffer. The unaligned tail is read normally.
+     * Falls back to readfile() if O_DIRECT is not supported by the system or the file system.
+     */
+    template<typename Type>
+    void readfile_direct(const char *file, const size_t num, Type *data) {
+#if defined(SZ_POSIX_IO) && defined(O_DIRECT)
+        int fd = open(file, O_RDONLY | O_DIRECT);
+        if (fd < 0) {
+            readfile(file, num, data);
+            return;
+        }
+        struct stat st;
+        const size_t bytes = num * sizeof(Type);
+        if (fstat(fd, &st) != 0 || (size_t) st.st_size != bytes) {
+            std::cout << " Error, file size of " << file << " is not equal to the input setting" << std::endl;
+            exit(0);
+        }
+        const size_t aligned_bytes = bytes / IO_ALIGNMENT * IO_ALIGNMENT;
+        const size_t block = 16 << 20;
+        char *dst = reinterpret_cast<char *>(data);
+        bool in_place = reinterpret_cast<uintptr_t>(dst) % IO_ALIGNMENT == 0;
+        AlignedBuffer<char> bounce;
+        if (!in_place) {
+            bounce = aligned_buffer<char>(block);
+        }
+        size_t pos = 0;
+        while (pos < aligned_bytes) {
+            size_t len = std::min(block, aligned_bytes - pos);
+            char *buf = in_place ? dst + pos : bounce.get();
+            ssize_t ret = pread(fd, buf, len, pos);
+            if (ret <= 0 || ret % IO_ALIGNMENT != 0) {
+                break;
+            }
+            if (!in_place) {
+                memcpy(dst + pos, buf, ret);
+            }
+            pos += ret;
+        }
+        close(fd);
+        if (pos < bytes) {
+            // the tail, or everything the file system refused to read directly
+            fd = open(file, O_RDONLY);
+            while (fd >= 0 && pos < bytes) {
+                ssize_t ret = pread(fd, dst + pos, bytes - pos, pos);
+                if (ret <= 0) {
+                    break;
+                }
+                pos += ret;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+            if (pos < bytes) {
+                std::cout << " Error, failed to read the file: " << file << std::endl;
+                exit(0);
+            }
+        }
+#else
+        readfile(file, num, data);
+#endif
+    }
+
+    /**
+     * Memory map of a binary file.
+     * Pages are loaded on first access and the kernel is told the access is sequential (and may use huge pages),
+     * so processing starts before the whole file is read and no extra copy is made.
+     * A writable map is private: compressors overwrite their input, and these writes never reach the file.
+     * Falls back to reading the whole file into memory if mmap is not available.
+     */
+    template<typename Type>
+    class MappedFile {
+    public:
+        MappedFile(const char *file, bool writable = false) {
+#ifdef SZ_POSIX_IO
+            int fd = open(file, O_RDONLY);
+            if (fd < 0) {
+                std::cout << " Error, Couldn't find the file: " << file << std::endl;
+                exit(0);
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                std::cout << " Error, Couldn't read the file: " << file << std::endl;
+                exit(0);
+            }
+            bytes = st.st_size;
+            num = bytes / sizeof(Type);
+            if (bytes > 0) {
+                void *p = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, bytes, MADV_SEQUENTIAL);
+                    madvise(p, bytes, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+                    madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+                    ptr = static_cast<Type *>(p);
+                }
+            }
+            close(fd);
+            if (ptr != nullptr || bytes == 0) {
+                return;
+            }
+#endif
+            buffer = readfile<Type>(file, num);
+            ptr = buffer.get();
+            bytes = 0;
+        }
+
+        ~MappedFile() {
+#ifdef SZ_POSIX_IO
+            if (bytes > 0) {
+                munmap(ptr, bytes);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        Type *data() const { return ptr; }
+
+        size_t size() const { return num; }
+
+    private:
+        Type *ptr = nullptr;
+        size_t num = 0;
+        size_t bytes = 0;                   // size of the map, 0 if not mapped
+        std::unique_ptr<Type[]> buffer;     // used if the file is not mapped
+    };
+
+    /**
+     * Read-ahead of input files: the next file is loaded on a background thread
+     * while the current one is being processed.
+     */
+    template<typename Type>
+    class FilePrefetcher {
+    public:
+        // start loading a file of num elements, with O_DIRECT if direct is set
+        void prefetch(const char *file, size_t num, bool direct = false) {
+            pending = std::async(std::launch::async, [path = std::string(file), num, direct]() {
+                auto data = aligned_buffer<Type>(num);
+                if (direct) {
+                    readfile_direct(path.c_str(), num, data.get());
+                } else {
+                    readfile(path.c_str(), num, data.get());
+                }
+                return data;
+            });
+        }
+
+        bool valid() const { return pending.valid(); }
+
+        // wait for the file given to the last prefetch()
+        AlignedBuffer<Type> get() { return pending.get(); }
+
+    private:
+        std::future<AlignedBuffer<Type>> pending;
+    };
+
     template<typename Type>
     void writeTextFile(const char *file, Type *data, size_t num_elements) {
         std::ofstream fout(file);
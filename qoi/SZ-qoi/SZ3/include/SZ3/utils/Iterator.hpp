@@ -68,6 +68,11 @@ namespace SZ {
             inline multi_dimensional_iterator &operator++() {
                 size_t i = N - 1;
                 local_index[i]++;
+                // fast path: no carry out of the innermost dimension
+                if (N == 1 || local_index[i] < range->dimensions[i]) {
+                    global_offset += range->global_dim_strides[i];
+                    return *this;
+                }
                 ptrdiff_t offset = range->global_dim_strides[i];
                 while (i && (local_index[i] == range->dimensions[i])) {
                     offset -= range->dimensions[i] * range->global_dim_strides[i];
@@ -142,13 +147,17 @@ namespace SZ {
             // return 0 if range is exceeded
             // [input] offset for all the dimensions
             // [output] value of data at the target position
+            // hot loops should precompute the offsets of a fixed stencil instead,
+            // see prev_in_range() and multi_dimensional_range::get_global_dim_strides()
             template<class... Args>
             inline T prev(Args &&... pos) const {
                 // TODO: check int type
-                // TODO: change to offset map for efficiency
                 static_assert(sizeof...(Args) == N, "Must have the same number of arguments");
+                return prev(std::array<int, N>{std::forward<Args>(pos)...});
+            }
+
+            inline T prev(const std::array<int, N> &args) const {
                 auto offset = global_offset;
-                std::array<int, N> args{std::forward<Args>(pos)...};
                 for (int i = 0; i < N; i++) {
                     if (local_index[i] < args[i] && range->is_left_boundary(i)) return 0;
                     offset -= args[i] ? args[i] * range->global_dim_strides[i] : 0;
@@ -156,6 +165,16 @@ namespace SZ {
                 return range->data[offset];
             }
 
+            // return true if prev() with offsets up to `layers` in every dimension
+            // never crosses the left boundary, i.e., the neighbors can be read directly
+            // from the data pointer
+            inline bool prev_in_range(size_t layers) const {
+                for (int i = 0; i < N; i++) {
+                    if (local_index[i] < layers && range->is_left_boundary(i)) return false;
+                }
+                return true;
+            }
+
             // No support for carry set.
             // For example, iterator in position (4,4) and dimension is 6x6, move(1,1) is supported but move (2,0) is not supported.
             template<class... Args>
@@ -348,6 +367,10 @@ namespace SZ {
             return global_dimensions;
         }
 
+        std::array<size_t, N> get_global_dim_strides() const {
+            return global_dim_strides;
+        }
+
         bool is_left_boundary(size_t i) const {
             return left_boundary[i];
         }
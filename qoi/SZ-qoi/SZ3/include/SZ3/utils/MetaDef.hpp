@@ -50,10 +50,17 @@ namespace SZMETA {
                     float precision = 0.0,
                     float _reg_eb_base = RegErrThreshold, float _reg_eb_1 = -1,
                     int cp = 0,
-                    float sr = 1.0, bool ll = true) :
-                block_size(bs), prediction_dim(pd),
-                use_lorenzo(lo), use_lorenzo_2layer(lo2), use_regression_linear(url),
-                capacity(cp), sample_ratio(sr), lossless(ll) {
+                    float sr = 1.0, bool ll = true) {
+            // the struct is written as is, zero its padding so that the compressed data only depend on the input
+            memset(this, 0, sizeof(*this));
+            block_size = bs;
+            prediction_dim = pd;
+            use_lorenzo = lo;
+            use_lorenzo_2layer = lo2;
+            use_regression_linear = url;
+            capacity = cp;
+            sample_ratio = sr;
+            lossless = ll;
             lorenzo_padding_layer = 2;
             reg_eb_base = _reg_eb_base;
             reg_eb_1 = _reg_eb_1;
@@ -107,6 +114,7 @@ namespace SZMETA {
         T mean;
 
         meanInfo(bool use = false, T mean_ = 0) {
+            memset(this, 0, sizeof(*this));
             use_mean = use;
             mean = mean_;
         }
@@ -0,0 +1,130 @@
+#ifndef SZ_METRICS_HPP
+#define SZ_METRICS_HPP
+
+/**
+ * Error metrics between original and decompressed data, computed in one parallel pass.
+ * Only depends on the standard library so that drivers outside SZ3 can use it directly.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+
+namespace SZ {
+
+    struct ErrorMetrics {
+        size_t num = 0;
+        double min = 0;             // of the original data
+        double max = 0;
+        double range = 0;
+        double max_abs_value = 0;   // L_inf norm of the original data
+        double max_abs_error = 0;
+        double max_rel_error = 0;   // max_abs_error / range
+        double max_pw_rel_error = 0;
+        double mse = 0;
+        double rmse = 0;
+        double nrmse = 0;
+        double psnr = 0;
+        double norm_error = 0;      // L2 norm of the error
+        double norm_error_norm = 0; // norm_error / L2 norm of the decompressed data
+        double mean_ori = 0;
+        double mean_dec = 0;
+        double mean_shift = 0;      // |mean_ori - mean_dec|
+        double ac_eff = 0;          // correlation between original and decompressed data
+        double max_x_square_error = 0;
+        double max_log_error = 0;   // only computed if requested
+    };
+
+    /**
+     * @param log_error also compute the max error of log2|x|, which costs two logarithms per element
+     */
+    template<class T>
+    ErrorMetrics compute_error_metrics(const T *ori_data, const T *dec_data, size_t num, bool log_error = false) {
+        ErrorMetrics m;
+        m.num = num;
+        if (num == 0) {
+            return m;
+        }
+        // moments are taken relative to the first value to limit cancellation
+        const double shift = ori_data[0];
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double max_abs_value = 0, max_err = 0, max_pw_rel = 0, max_x2 = 0, max_log = 0;
+        double sum_o = 0, sum_d = 0, sum_oo = 0, sum_dd = 0, sum_od = 0, sum_err2 = 0, l2_dec = 0;
+        const double log2_recip = 1 / std::log(2.0);
+
+#pragma omp parallel for simd schedule(static) \
+        reduction(min:min) reduction(max:max, max_abs_value, max_err, max_pw_rel, max_x2, max_log) \
+        reduction(+:sum_o, sum_d, sum_oo, sum_dd, sum_od, sum_err2, l2_dec)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t) num; i++) {
+            double o = ori_data[i];
+            double d = dec_data[i];
+            min = o < min ? o : min;
+            max = o > max ? o : max;
+            max_abs_value = std::fabs(o) > max_abs_value ? std::fabs(o) : max_abs_value;
+
+            double err = std::fabs(d - o);
+            max_err = err > max_err ? err : max_err;
+            if (o != 0) {
+                double rel = err / std::fabs(o);
+                max_pw_rel = rel > max_pw_rel ? rel : max_pw_rel;
+            }
+            sum_err2 += err * err;
+            l2_dec += d * d;
+
+            double os = o - shift, ds = d - shift;
+            sum_o += os;
+            sum_d += ds;
+            sum_oo += os * os;
+            sum_dd += ds * ds;
+            sum_od += os * ds;
+
+            double x2 = std::fabs(o * o - d * d);
+            max_x2 = x2 > max_x2 ? x2 : max_x2;
+            if (log_error && o != 0 && o != d) {
+                double le = std::fabs(std::log(std::fabs(o)) - std::log(std::fabs(d))) * log2_recip;
+                max_log = le > max_log ? le : max_log;
+            }
+        }
+
+        m.min = min;
+        m.max = max;
+        m.range = max - min;
+        m.max_abs_value = max_abs_value;
+        m.max_abs_error = max_err;
+        m.max_rel_error = max_err / m.range;
+        m.max_pw_rel_error = max_pw_rel;
+        m.mse = sum_err2 / num;
+        m.rmse = std::sqrt(m.mse);
+        m.nrmse = m.rmse / m.range;
+        m.psnr = 20 * log10(m.range) - 10 * log10(m.mse);
+        m.norm_error = std::sqrt(sum_err2);
+        m.norm_error_norm = m.norm_error / std::sqrt(l2_dec);
+
+        double mean_o = sum_o / num, mean_d = sum_d / num;
+        m.mean_ori = shift + mean_o;
+        m.mean_dec = shift + mean_d;
+        m.mean_shift = std::fabs(mean_o - mean_d);
+        double var_o = sum_oo / num - mean_o * mean_o;
+        double var_d = sum_dd / num - mean_d * mean_d;
+        double cov = sum_od / num - mean_o * mean_d;
+        m.ac_eff = cov / std::sqrt(var_o) / std::sqrt(var_d);
+
+        m.max_x_square_error = max_x2;
+        m.max_log_error = max_log;
+        return m;
+    }
+
+    inline void print_error_metrics(const ErrorMetrics &m) {
+        printf("Min=%.20G, Max=%.20G, range=%.20G\n", m.min, m.max, m.range);
+        printf("Max absolute error = %.2G\n", m.max_abs_error);
+        printf("Max relative error = %.2G\n", m.max_rel_error);
+        printf("Max pw relative error = %.2G\n", m.max_pw_rel_error);
+        printf("PSNR = %f, NRMSE= %.10G\n", m.psnr, m.nrmse);
+        printf("normError = %f, normErr_norm = %f\n", m.norm_error, m.norm_error_norm);
+        printf("acEff=%f\n", m.ac_eff);
+    }
+}
+
+#endif
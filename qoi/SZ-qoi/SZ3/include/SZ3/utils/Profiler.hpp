@@ -0,0 +1,200 @@
+#ifndef SZ3_PROFILER_HPP
+#define SZ3_PROFILER_HPP
+
+/**
+ * Per-stage instrumentation of compression and decompression.
+ * A ProfileScope measures one stage from construction to destruction (or stop()), and adds its time and byte counts
+ * to counters owned by the calling thread, so OpenMP threads never contend.
+ * Scopes nest: the time of a scope is also counted in the enclosing scope, and self_time excludes nested scopes.
+ * profile_snapshot() sums the counters of all threads; the difference of two snapshots covers the calls in between.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace SZ {
+
+    enum STAGE {
+        STAGE_SAMPLING,     // gathering samples for tuning
+        STAGE_TUNING,       // parameter search, including the trial compressions on samples
+        STAGE_PREDICTION,   // prediction and quantization, or the reverse in decompression
+        STAGE_HISTOGRAM,    // counting quantization indices that were not counted during quantization
+        STAGE_HUFFMAN,      // Huffman tree, encoding and decoding
+        STAGE_LOSSLESS,     // zstd
+        STAGE_CONFIG,       // config and container serialization
+        STAGE_NUM
+    };
+    const char *STAGE_STR[] = {"sampling", "tuning", "prediction", "histogram", "huffman", "lossless", "config"};
+
+    struct StageProfile {
+        double time = 0;        // seconds, including nested stages
+        double self_time = 0;   // seconds, excluding nested stages
+        size_t calls = 0;
+        size_t bytes_in = 0;
+        size_t bytes_out = 0;
+    };
+
+    struct Profile {
+        std::array<StageProfile, STAGE_NUM> stages;
+
+        const StageProfile &operator[](STAGE stage) const { return stages[stage]; }
+
+        Profile operator-(const Profile &other) const {
+            Profile p;
+            for (int i = 0; i < STAGE_NUM; i++) {
+                p.stages[i].time = stages[i].time - other.stages[i].time;
+                p.stages[i].self_time = stages[i].self_time - other.stages[i].self_time;
+                p.stages[i].calls = stages[i].calls - other.stages[i].calls;
+                p.stages[i].bytes_in = stages[i].bytes_in - other.stages[i].bytes_in;
+                p.stages[i].bytes_out = stages[i].bytes_out - other.stages[i].bytes_out;
+            }
+            return p;
+        }
+
+        void print() const {
+            printf("%-12s %8s %12s %12s %14s %14s\n", "stage", "calls", "time(s)", "self(s)", "bytes in", "bytes out");
+            for (int i = 0; i < STAGE_NUM; i++) {
+                const auto &s = stages[i];
+                if (s.calls) {
+                    printf("%-12s %8zu %12.6f %12.6f %14zu %14zu\n", STAGE_STR[i], s.calls, s.time, s.self_time,
+                           s.bytes_in, s.bytes_out);
+                }
+            }
+        }
+    };
+
+    class ProfileScope;
+
+    namespace profiler_detail {
+
+        // counters are only written by the owning thread, atomics make concurrent snapshots well defined
+        struct StageCounters {
+            std::atomic<uint64_t> ns{0}, self_ns{0}, calls{0}, bytes_in{0}, bytes_out{0};
+        };
+
+        inline void add(std::atomic<uint64_t> &counter, uint64_t v) {
+            counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+        }
+
+        inline void accumulate(Profile &p, const std::array<StageCounters, STAGE_NUM> &counters) {
+            for (int i = 0; i < STAGE_NUM; i++) {
+                p.stages[i].time += counters[i].ns.load(std::memory_order_relaxed) * 1e-9;
+                p.stages[i].self_time += counters[i].self_ns.load(std::memory_order_relaxed) * 1e-9;
+                p.stages[i].calls += counters[i].calls.load(std::memory_order_relaxed);
+                p.stages[i].bytes_in += counters[i].bytes_in.load(std::memory_order_relaxed);
+                p.stages[i].bytes_out += counters[i].bytes_out.load(std::memory_order_relaxed);
+            }
+        }
+
+        struct ThreadCounters;
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<ThreadCounters *> threads;
+            Profile retired;    // counters of threads that have exited
+        };
+
+        inline Registry &registry() {
+            static Registry r;
+            return r;
+        }
+
+        struct ThreadCounters {
+            std::array<StageCounters, STAGE_NUM> stages;
+            ProfileScope *current = nullptr;
+
+            ThreadCounters() {
+                auto &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.threads.push_back(this);
+            }
+
+            ~ThreadCounters() {
+                auto &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                accumulate(r.retired, stages);
+                for (auto &t: r.threads) {
+                    if (t == this) {
+                        t = r.threads.back();
+                        r.threads.pop_back();
+                        break;
+                    }
+                }
+            }
+        };
+
+        inline ThreadCounters &thread_counters() {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+    }
+
+    class ProfileScope {
+    public:
+        explicit ProfileScope(STAGE stage, size_t bytes_in = 0) :
+                stage(stage), bytes_in(bytes_in), counters(profiler_detail::thread_counters()),
+                parent(counters.current), begin(std::chrono::steady_clock::now()) {
+            counters.current = this;
+        }
+
+        ~ProfileScope() {
+            stop();
+        }
+
+        // end the stage before the end of the scope, scopes of one thread have to be stopped in reverse order
+        void stop() {
+            if (stopped) {
+                return;
+            }
+            stopped = true;
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+            auto &c = counters.stages[stage];
+            profiler_detail::add(c.ns, ns);
+            profiler_detail::add(c.self_ns, ns > child_ns ? ns - child_ns : 0);
+            profiler_detail::add(c.calls, 1);
+            profiler_detail::add(c.bytes_in, bytes_in);
+            profiler_detail::add(c.bytes_out, bytes_out);
+            if (parent) {
+                parent->child_ns += ns;
+            }
+            counters.current = parent;
+        }
+
+        ProfileScope(const ProfileScope &) = delete;
+
+        ProfileScope &operator=(const ProfileScope &) = delete;
+
+        void add_bytes_in(size_t bytes) { bytes_in += bytes; }
+
+        void add_bytes_out(size_t bytes) { bytes_out += bytes; }
+
+    private:
+        STAGE stage;
+        size_t bytes_in;
+        size_t bytes_out = 0;
+        uint64_t child_ns = 0;
+        bool stopped = false;
+        profiler_detail::ThreadCounters &counters;
+        ProfileScope *parent;
+        std::chrono::steady_clock::time_point begin;
+    };
+
+    // counters of all threads since the start of the program
+    inline Profile profile_snapshot() {
+        auto &r = profiler_detail::registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Profile p = r.retired;
+        for (auto t: r.threads) {
+            profiler_detail::accumulate(p, t->stages);
+        }
+        return p;
+    }
+}
+
+#endif
@@ -87,10 +87,8 @@ namespace SZ {
 
     template<typename T>
     int optimize_quant_invl_3d(const T *data, size_t r1, size_t r2, size_t r3, double precision) {
-        float mean_rough = sample_rough_mean_3d(data, r1, r2, r3, sqrt(r1 * r2 * r3));
+        // only the histogram of prediction errors is needed to pick the number of intervals
         std::vector<size_t> intervals = std::vector<size_t>(QuantIntvSampleCapacity, 0);
-        std::vector<size_t> freq_intervals = std::vector<size_t>(QuantIntvMeanCapacity, 0);
-        size_t freq_count = 0;
         size_t sample_count = 0;
         size_t sample_distance = QuantIntvSampleDistance;
         size_t offset_count = sample_distance - 2; // count r3 offset
@@ -100,31 +98,17 @@ namespace SZ {
         const T *data_pos = data + r23 + r3 + offset_count;
         size_t n1_count = 1, n2_count = 1; // count i,j sum
         T pred_value = 0;
-        double mean_diff = 0;
-        ptrdiff_t freq_index = 0;
         size_t pred_index = 0;
         float pred_err = 0;
-        int radius = (QuantIntvMeanCapacity >> 1);
         while (data_pos - data < len) {
             pred_value = SZMETA::lorenzo_predict_3d(data_pos, r23, r3);
             pred_err = fabs(pred_value - *data_pos);
-            if (pred_err < precision) freq_count++;
             pred_index = (pred_err / precision + 1) / 2;
             if (pred_index >= intervals.size()) {
                 pred_index = intervals.size() - 1;
             }
             intervals[pred_index]++;
 
-            mean_diff = *data_pos - mean_rough;
-            if (mean_diff > 0) freq_index = (ptrdiff_t) (mean_diff / precision) + radius;
-            else freq_index = (ptrdiff_t) (mean_diff / precision) - 1 + radius;
-            if (freq_index <= 0) {
-                freq_intervals[0]++;
-            } else if (freq_index >= freq_intervals.size()) {
-                freq_intervals[freq_intervals.size() - 1]++;
-            } else {
-                freq_intervals[freq_index]++;
-            }
             offset_count += sample_distance;
             if (offset_count >= r3) {
                 n2_count++;
@@ -140,9 +124,6 @@ namespace SZ {
             } else data_pos += sample_distance;
             sample_count++;
         }
-        float pred_freq = freq_count * 1.0 / sample_count;
-        float mean_guess = mean_rough;
-        float mean_freq = estimate_mean_freq_and_position(freq_intervals, precision, sample_count, mean_guess);
         return estimate_quantization_intervals(intervals, sample_count);
     }
 }
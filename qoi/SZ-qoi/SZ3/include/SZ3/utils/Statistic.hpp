@@ -6,6 +6,9 @@
 #define SZ_STATISTIC_HPP
 
 #include "Config.hpp"
+#include "Metrics.hpp"
+#include <cmath>
+#include <limits>
 
 namespace SZ {
     template<class T>
@@ -19,6 +22,66 @@ namespace SZ {
         return max - min;
     }
 
+    // min, max, mean, variance, zero and NaN/Inf counts in one parallel pass
+    template<class T>
+    DataStats compute_data_stats(const T *data, size_t num) {
+        DataStats stats;
+        stats.valid = true;
+        stats.data = data;
+        stats.num = num;
+
+        // sums are taken relative to the first finite value to limit cancellation in the variance
+        double shift = 0;
+        for (size_t i = 0; i < num; i++) {
+            if (std::isfinite((double) data[i])) {
+                shift = data[i];
+                break;
+            }
+        }
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double sum = 0, sum2 = 0;
+        size_t finite = 0, zeros = 0, nans = 0, infs = 0;
+#pragma omp parallel for simd schedule(static) reduction(min:min) reduction(max:max) reduction(+:sum, sum2, finite, zeros, nans, infs)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t) num; i++) {
+            double v = data[i];
+            if (std::isnan(v)) {
+                nans++;
+            } else if (std::isinf(v)) {
+                infs++;
+            } else {
+                min = v < min ? v : min;
+                max = v > max ? v : max;
+                double d = v - shift;
+                sum += d;
+                sum2 += d * d;
+                finite++;
+                zeros += (v == 0);
+            }
+        }
+        stats.zeroCount = zeros;
+        stats.nanCount = nans;
+        stats.infCount = infs;
+        if (finite) {
+            stats.min = min;
+            stats.max = max;
+            stats.range = (T) max - (T) min;
+            double mean_shifted = sum / finite;
+            stats.mean = shift + mean_shifted;
+            stats.variance = std::max(0.0, sum2 / finite - mean_shifted * mean_shifted);
+        }
+        return stats;
+    }
+
+    // statistics of the field conf describes, computed on first use and cached in conf
+    template<class T>
+    const DataStats &get_data_stats(Config &conf, const T *data) {
+        if (!conf.dataStats.valid || conf.dataStats.data != data || conf.dataStats.num != conf.num) {
+            conf.dataStats = compute_data_stats(data, conf.num);
+        }
+        return conf.dataStats;
+    }
+
     int factorial(int n) {
         return (n == 0) || (n == 1) ? 1 : n * factorial(n - 1);
     }
@@ -35,19 +98,19 @@ namespace SZ {
         if (conf.errorBoundMode != EB_ABS) {
             if (conf.errorBoundMode == EB_REL) {
                 conf.errorBoundMode = EB_ABS;
-                conf.absErrorBound = conf.relErrorBound * SZ::data_range(data, conf.num);
+                conf.absErrorBound = conf.relErrorBound * get_data_stats(conf, data).range;
             } else if (conf.errorBoundMode == EB_PSNR) {
                 conf.errorBoundMode = EB_ABS;
-                conf.absErrorBound = computeABSErrBoundFromPSNR(conf.psnrErrorBound, 0.99, SZ::data_range(data, conf.num));
+                conf.absErrorBound = computeABSErrBoundFromPSNR(conf.psnrErrorBound, 0.99, get_data_stats(conf, data).range);
             } else if (conf.errorBoundMode == EB_L2NORM) {
                 conf.errorBoundMode = EB_ABS;
                 conf.absErrorBound = sqrt(3.0 / conf.num) * conf.l2normErrorBound;
             } else if (conf.errorBoundMode == EB_ABS_AND_REL) {
                 conf.errorBoundMode = EB_ABS;
-                conf.absErrorBound = std::min(conf.absErrorBound, conf.relErrorBound * SZ::data_range(data, conf.num));
+                conf.absErrorBound = std::min(conf.absErrorBound, conf.relErrorBound * get_data_stats(conf, data).range);
             } else if (conf.errorBoundMode == EB_ABS_OR_REL) {
                 conf.errorBoundMode = EB_ABS;
-                conf.absErrorBound = std::max(conf.absErrorBound, conf.relErrorBound * SZ::data_range(data, conf.num));
+                conf.absErrorBound = std::max(conf.absErrorBound, conf.relErrorBound * get_data_stats(conf, data).range);
             } else {
                 printf("Error, error bound mode not supported\n");
                 exit(0);
@@ -242,67 +305,10 @@ namespace SZ {
 
     template<typename Type>
     void verify(Type *ori_data, Type *data, size_t num_elements, double &psnr, double &nrmse) {
-        size_t i = 0;
-        double Max = ori_data[0];
-        double Min = ori_data[0];
-        double diffMax = fabs(data[0] - ori_data[0]);
-        double diff_sum = 0;
-        double maxpw_relerr = 0;
-        double sum1 = 0, sum2 = 0, l2sum = 0;
-        for (i = 0; i < num_elements; i++) {
-            sum1 += ori_data[i];
-            sum2 += data[i];
-            l2sum += data[i] * data[i];
-        }
-        double mean1 = sum1 / num_elements;
-        double mean2 = sum2 / num_elements;
-
-        double sum3 = 0, sum4 = 0;
-        double sum = 0, prodSum = 0, relerr = 0;
-
-        double *diff = (double *) malloc(num_elements * sizeof(double));
-
-        for (i = 0; i < num_elements; i++) {
-            diff[i] = data[i] - ori_data[i];
-            diff_sum += data[i] - ori_data[i];
-            if (Max < ori_data[i]) Max = ori_data[i];
-            if (Min > ori_data[i]) Min = ori_data[i];
-            double err = fabs(data[i] - ori_data[i]);
-            if (ori_data[i] != 0) {
-                relerr = err / fabs(ori_data[i]);
-                if (maxpw_relerr < relerr)
-                    maxpw_relerr = relerr;
-            }
-
-            if (diffMax < err)
-                diffMax = err;
-            prodSum += (ori_data[i] - mean1) * (data[i] - mean2);
-            sum3 += (ori_data[i] - mean1) * (ori_data[i] - mean1);
-            sum4 += (data[i] - mean2) * (data[i] - mean2);
-            sum += err * err;
-        }
-        double std1 = sqrt(sum3 / num_elements);
-        double std2 = sqrt(sum4 / num_elements);
-        double ee = prodSum / num_elements;
-        double acEff = ee / std1 / std2;
-
-        double mse = sum / num_elements;
-        double range = Max - Min;
-        psnr = 20 * log10(range) - 10 * log10(mse);
-        nrmse = sqrt(mse) / range;
-
-        double normErr = sqrt(sum);
-        double normErr_norm = normErr / sqrt(l2sum);
-
-        printf("Min=%.20G, Max=%.20G, range=%.20G\n", Min, Max, range);
-        printf("Max absolute error = %.2G\n", diffMax);
-        printf("Max relative error = %.2G\n", diffMax / (Max - Min));
-        printf("Max pw relative error = %.2G\n", maxpw_relerr);
-        printf("PSNR = %f, NRMSE= %.10G\n", psnr, nrmse);
-        printf("normError = %f, normErr_norm = %f\n", normErr, normErr_norm);
-        printf("acEff=%f\n", acEff);
-//        printf("errAutoCorr=%.10f\n", autocorrelation1DLag1<double>(diff, num_elements, diff_sum / num_elements));
-        free(diff);
+        auto metrics = compute_error_metrics(ori_data, data, num_elements);
+        print_error_metrics(metrics);
+        psnr = metrics.psnr;
+        nrmse = metrics.nrmse;
     }
 
     template<typename Type>
@@ -311,61 +317,17 @@ namespace SZ {
         for(const auto d:dims){
             num_elements *= d;
         }
-        double psnr = 0;
-        double nrmse = 0;
-        verify(ori_data, data, num_elements, psnr, nrmse);
-        Type max = ori_data[0];
-        Type min = ori_data[0];
-        for (size_t i = 1; i < num_elements; i++) {
-            if (max < ori_data[i]) max = ori_data[i];
-            if (min > ori_data[i]) min = ori_data[i];
-        }
-
-        double max_abs_val = std::max(fabs(max), fabs(min));
-        double max_abs_val_sq = max_abs_val * max_abs_val;
-        double max_x_square_diff = 0;
-        double max_log_diff = 0;
-        for(int i=0; i<num_elements; i++){
-            double x_square_diff = fabs(ori_data[i] * ori_data[i] - data[i] * data[i]);
-            if(x_square_diff > max_x_square_diff) max_x_square_diff = x_square_diff;
-            // if(x_square_diff / max_abs_val_sq > 1e-5){
-            //     std::cout << i << ": ori = " << ori_data[i] << ", dec = " << data[i] << ", err = " << x_square_diff / max_abs_val_sq << std::endl;
-            // }
-            if(ori_data[i] == 0){
-                // for log x only
-                // if(data[i] != 0){
-                //     std::cout << i << ": dec_data does not equal to 0\n";
-                // }
-            }
-            else{
-                if(ori_data[i] == data[i]) continue;
-                double log2 = log(2);
-                double log_diff = fabs(log(fabs(ori_data[i]))/log2 - log(fabs(data[i]))/log2);
-                if(log_diff > max_log_diff) max_log_diff = log_diff;  
-                // if(log_diff > 1){
-                //     std::cout << i << ": " << ori_data[i] << " " << data[i] << std::endl;
-                // }              
-            }
-        }
+        // the generic and QoI metrics come from the same pass
+        auto metrics = compute_error_metrics(ori_data, data, num_elements, true);
+        print_error_metrics(metrics);
 
+        double max_abs_val_sq = metrics.max_abs_value * metrics.max_abs_value;
         printf("QoI error info:\n");
-        printf("Max x^2 error = %.6G, relative x^2 error = %.6G\n", max_x_square_diff, max_x_square_diff / max_abs_val_sq);
-        printf("Max log error = %.6G\n", max_log_diff);
+        printf("Max x^2 error = %.6G, relative x^2 error = %.6G\n", metrics.max_x_square_error, metrics.max_x_square_error / max_abs_val_sq);
+        printf("Max log error = %.6G\n", metrics.max_log_error);
 
-        for(int i=0; i<num_elements; i++){
-            //ori_data[i] = ori_data[i] * ori_data[i];
-            //data[i] = data[i] * data[i];
-	    ori_data[i] = ori_data[i];
-	    data[i] = data[i];
-        }
-        max = ori_data[0];
-        min = ori_data[0];
-        for (size_t i = 1; i < num_elements; i++) {
-            if (max < ori_data[i]) max = ori_data[i];
-            if (min > ori_data[i]) min = ori_data[i];
-        }
-        if(dims.size() == 2) evaluate_average(ori_data, data, max - min, 1, dims[0], dims[1], blockSize);
-        else if(dims.size() == 3) evaluate_average(ori_data, data, max - min, dims[0], dims[1], dims[2], blockSize);
+        if(dims.size() == 2) evaluate_average(ori_data, data, (Type) metrics.range, 1, dims[0], dims[1], blockSize);
+        else if(dims.size() == 3) evaluate_average(ori_data, data, (Type) metrics.range, dims[0], dims[1], dims[2], blockSize);
 
     }
 
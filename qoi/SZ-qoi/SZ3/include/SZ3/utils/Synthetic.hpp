@@ -0,0 +1,339 @@
+#ifndef SZ3_SYNTHETIC_HPP
+#define SZ3_SYNTHETIC_HPP
+
+/**
+ * Deterministic synthetic fields for benchmarking without the SDRBench files.
+ * Every value only depends on its coordinates and the seed, so the output is identical for any number of threads.
+ * Only the standard library is used, drivers outside SZ3 can include this header on its own.
+ *
+ * kinds:
+ *   grf      Gaussian random field with zero mean and unit variance, the power spectrum decays as k^-slope
+ *   cloud    sparse non-negative field, a thresholded random field where about 70% of the values are 0
+ *   smooth   sum of sines and Gaussian bumps
+ *   particle particle-like 2D data [particles][attributes]: perturbed lattice positions, then Gaussian velocities
+ *
+ * Spec strings accepted by synthetic_load(): "synthetic:<kind>[:<seed>[:<slope>]]",
+ * and "random" for the legacy option of the drivers, which now selects the default grf.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace SZ {
+
+    enum SYNTHETIC {
+        SYNTHETIC_GRF, SYNTHETIC_CLOUD, SYNTHETIC_SMOOTH, SYNTHETIC_PARTICLE
+    };
+    const char *SYNTHETIC_STR[] = {"grf", "cloud", "smooth", "particle"};
+
+    constexpr uint64_t SYNTHETIC_SEED = 7117;
+    constexpr double SYNTHETIC_SLOPE = 3;
+
+    namespace synthetic_detail {
+
+        // splitmix64 finalizer
+        inline uint64_t mix(uint64_t x) {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        inline uint64_t hash(uint64_t h, uint64_t v) {
+            return mix(h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)));
+        }
+
+        inline double uniform(uint64_t h) {
+            return (h >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        // approximately standard normal: sum of four 16 bit uniforms, scaled to unit variance
+        inline double gaussian(uint64_t h) {
+            double s = 0;
+            for (int i = 0; i < 4; i++) {
+                s += (h >> (16 * i) & 0xffff) * (1.0 / 65536);
+            }
+            return (s - 2) * 1.7320508075688772;
+        }
+
+        inline double fade(double t) {
+            return t * t * t * (t * (t * 6 - 15) + 10);
+        }
+
+        inline size_t num_elements(const std::vector<size_t> &dims) {
+            size_t num = 1;
+            for (auto d: dims) num *= d;
+            return num;
+        }
+
+        /**
+         * Sum of value noise octaves, octave o has lattice spacing L/2^o and amplitude (2^o)^((1-slope)/2),
+         * so the energy per octave follows k^-slope.
+         * The field is built row by row along the fastest dimension: in a row the interpolation weights of the other
+         * dimensions are constant, so each octave collapses to a 1D lattice interpolated along the row.
+         * The raw values are written to data, and the sum and square sum of each row to row_sum and row_sqsum.
+         */
+        template<class T>
+        void noise(T *data, const std::vector<size_t> &dims, uint64_t seed, double slope,
+                   std::vector<double> &row_sum, std::vector<double> &row_sqsum) {
+            const int N = dims.size();
+            const size_t row_len = dims[N - 1];
+            const size_t rows = num_elements(dims) / row_len;
+            size_t L = 1;
+            for (auto d: dims) L = std::max(L, d);
+            int octaves = 1;
+            while ((double) L / (1 << octaves) >= 2) octaves++;
+            row_sum.assign(rows, 0);
+            row_sqsum.assign(rows, 0);
+
+#pragma omp parallel
+            {
+                std::vector<double> acc(row_len), line;
+                std::vector<size_t> coords(N);
+#pragma omp for schedule(static)
+                for (ptrdiff_t r = 0; r < (ptrdiff_t) rows; r++) {
+                    size_t idx = r;
+                    for (int d = N - 2; d >= 0; d--) {
+                        coords[d] = idx % dims[d];
+                        idx /= dims[d];
+                    }
+                    std::fill(acc.begin(), acc.end(), 0);
+                    for (int o = 0; o < octaves; o++) {
+                        double spacing = (double) L / (1 << o);
+                        double amplitude = std::pow((double) (1 << o), (1 - slope) / 2);
+                        uint64_t h_octave = hash(seed, o);
+                        size_t cells = (size_t) ((row_len - 1) / spacing) + 2;
+                        line.assign(cells, 0);
+                        // the 2^(N-1) lattice corners around the row in the slower dimensions
+                        for (int corner = 0; corner < (1 << (N - 1)); corner++) {
+                            double w = 1;
+                            uint64_t h = h_octave;
+                            for (int d = 0; d < N - 1; d++) {
+                                double pos = coords[d] / spacing;
+                                size_t i0 = (size_t) pos;
+                                double t = fade(pos - i0);
+                                bool upper = corner >> d & 1;
+                                w *= upper ? t : 1 - t;
+                                h = hash(h, i0 + upper);
+                            }
+                            if (w == 0) continue;
+                            for (size_t c = 0; c < cells; c++) {
+                                line[c] += w * gaussian(hash(h, c));
+                            }
+                        }
+                        double inv_spacing = 1 / spacing;
+                        for (size_t j = 0; j < row_len; j++) {
+                            double pos = j * inv_spacing;
+                            size_t c = (size_t) pos;
+                            double t = fade(pos - c);
+                            acc[j] += amplitude * (line[c] + t * (line[c + 1] - line[c]));
+                        }
+                    }
+                    T *out = data + r * row_len;
+                    double sum = 0, sqsum = 0;
+                    for (size_t j = 0; j < row_len; j++) {
+                        out[j] = acc[j];
+                        sum += acc[j];
+                        sqsum += acc[j] * acc[j];
+                    }
+                    row_sum[r] = sum;
+                    row_sqsum[r] = sqsum;
+                }
+            }
+        }
+
+        // rows are summed in order, so that the normalization does not depend on the thread count
+        template<class T>
+        void normalize(T *data, size_t num, const std::vector<double> &row_sum, const std::vector<double> &row_sqsum) {
+            double sum = 0, sqsum = 0;
+            for (size_t r = 0; r < row_sum.size(); r++) {
+                sum += row_sum[r];
+                sqsum += row_sqsum[r];
+            }
+            double mean = sum / num;
+            double var = sqsum / num - mean * mean;
+            double scale = var > 0 ? 1 / std::sqrt(var) : 1;
+#pragma omp parallel for schedule(static)
+            for (ptrdiff_t i = 0; i < (ptrdiff_t) num; i++) {
+                data[i] = (data[i] - mean) * scale;
+            }
+        }
+    }
+
+    /**
+     * Gaussian random field, zero mean and unit variance
+     * @param dims dims[0] is the slowest dimension
+     * @param slope exponent of the power spectrum, larger is smoother (5/3 for Kolmogorov turbulence)
+     */
+    template<class T>
+    void synthetic_grf(T *data, const std::vector<size_t> &dims, uint64_t seed = SYNTHETIC_SEED,
+                       double slope = SYNTHETIC_SLOPE) {
+        std::vector<double> row_sum, row_sqsum;
+        synthetic_detail::noise(data, dims, seed, slope, row_sum, row_sqsum);
+        synthetic_detail::normalize(data, synthetic_detail::num_elements(dims), row_sum, row_sqsum);
+    }
+
+    // cloud-like field, zero outside the regions where the random field exceeds 0.5
+    template<class T>
+    void synthetic_cloud(T *data, const std::vector<size_t> &dims, uint64_t seed = SYNTHETIC_SEED,
+                         double slope = SYNTHETIC_SLOPE) {
+        synthetic_grf(data, dims, seed, slope);
+        size_t num = synthetic_detail::num_elements(dims);
+#pragma omp parallel for schedule(static)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t) num; i++) {
+            double v = data[i] - 0.5;
+            data[i] = v > 0 ? v * std::sqrt(v) : 0;
+        }
+    }
+
+    // a few sines per dimension plus four Gaussian bumps, on the unit cube
+    template<class T>
+    void synthetic_smooth(T *data, const std::vector<size_t> &dims, uint64_t seed = SYNTHETIC_SEED) {
+        using namespace synthetic_detail;
+        const int N = dims.size();
+        const int bumps = 4;
+        std::vector<double> freq(N), phase(N), center(bumps * N), width(bumps), height(bumps);
+        uint64_t h = mix(seed);
+        for (int d = 0; d < N; d++) {
+            freq[d] = 1 + 3 * uniform(h = hash(h, d));
+            phase[d] = 2 * M_PI * uniform(h = hash(h, d));
+        }
+        for (int b = 0; b < bumps; b++) {
+            for (int d = 0; d < N; d++) {
+                center[b * N + d] = uniform(h = hash(h, b));
+            }
+            width[b] = 0.05 + 0.15 * uniform(h = hash(h, b));
+            height[b] = 2 * uniform(h = hash(h, b)) - 1;
+        }
+        size_t num = num_elements(dims);
+#pragma omp parallel for schedule(static)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t) num; i++) {
+            double x[8];
+            size_t idx = i;
+            for (int d = N - 1; d >= 0; d--) {
+                x[d] = (double) (idx % dims[d]) / dims[d];
+                idx /= dims[d];
+            }
+            double v = 0;
+            for (int d = 0; d < N; d++) {
+                v += std::sin(2 * M_PI * freq[d] * x[d] + phase[d]) / N;
+            }
+            for (int b = 0; b < bumps; b++) {
+                double r2 = 0;
+                for (int d = 0; d < N; d++) {
+                    double dx = x[d] - center[b * N + d];
+                    r2 += dx * dx;
+                }
+                v += height[b] * std::exp(-r2 / (2 * width[b] * width[b]));
+            }
+            data[i] = v;
+        }
+    }
+
+    /**
+     * Particle-like data laid out as [particles][attributes], the last dimension is the attribute count
+     * The first three attributes are positions on a cubic lattice with thermal noise, the others are velocities.
+     */
+    template<class T>
+    void synthetic_particle(T *data, const std::vector<size_t> &dims, uint64_t seed = SYNTHETIC_SEED) {
+        using namespace synthetic_detail;
+        const size_t attrs = dims.size() > 1 ? dims.back() : 1;
+        const size_t particles = num_elements(dims) / attrs;
+        size_t side = std::ceil(std::cbrt((double) particles));
+        const double lattice = 3.615;   // lattice constant of copper, in angstrom
+        uint64_t h_seed = mix(seed);
+#pragma omp parallel for schedule(static)
+        for (ptrdiff_t p = 0; p < (ptrdiff_t) particles; p++) {
+            size_t site[3] = {p % side, p / side % side, p / side / side};
+            uint64_t h = hash(h_seed, p);
+            for (size_t a = 0; a < attrs; a++) {
+                double noise = gaussian(hash(h, a));
+                data[p * attrs + a] = a < 3 ? lattice * site[a] + 0.05 * lattice * noise : noise;
+            }
+        }
+    }
+
+    template<class T>
+    void synthetic_field(T *data, const std::vector<size_t> &dims, SYNTHETIC kind, uint64_t seed = SYNTHETIC_SEED,
+                         double slope = SYNTHETIC_SLOPE) {
+        if (dims.empty() || dims.size() > 8) {
+            printf("Error, synthetic fields support 1 to 8 dimensions\n");
+            exit(0);
+        }
+        if (!std::is_floating_point<T>::value) {
+            // generate in double and round, integer steps would flatten the normalized fields
+            std::vector<double> field(synthetic_detail::num_elements(dims));
+            synthetic_field(field.data(), dims, kind, seed, slope);
+            for (size_t i = 0; i < field.size(); i++) {
+                data[i] = (T) std::lround(field[i]);
+            }
+            return;
+        }
+        switch (kind) {
+            case SYNTHETIC_GRF:
+                synthetic_grf(data, dims, seed, slope);
+                break;
+            case SYNTHETIC_CLOUD:
+                synthetic_cloud(data, dims, seed, slope);
+                break;
+            case SYNTHETIC_SMOOTH:
+                synthetic_smooth(data, dims, seed);
+                break;
+            case SYNTHETIC_PARTICLE:
+                synthetic_particle(data, dims, seed);
+                break;
+        }
+    }
+
+    // whether the input path names a synthetic field instead of a file
+    inline bool synthetic_check(const std::string &spec) {
+        return spec == "random" || spec.compare(0, 10, "synthetic:") == 0;
+    }
+
+    /**
+     * Fill data with the synthetic field named by spec, see the top of this file for the format
+     * @return false if spec is not a synthetic field (it is a file path)
+     */
+    template<class T>
+    bool synthetic_load(const std::string &spec, T *data, const std::vector<size_t> &dims) {
+        if (!synthetic_check(spec)) {
+            return false;
+        }
+        SYNTHETIC kind = SYNTHETIC_GRF;
+        uint64_t seed = SYNTHETIC_SEED;
+        double slope = SYNTHETIC_SLOPE;
+        if (spec != "random") {
+            std::vector<std::string> fields;
+            size_t begin = 10, end;
+            do {
+                end = spec.find(':', begin);
+                fields.push_back(spec.substr(begin, end == std::string::npos ? end : end - begin));
+                begin = end + 1;
+            } while (end != std::string::npos);
+            int k = 0;
+            while (k <= SYNTHETIC_PARTICLE && fields[0] != SYNTHETIC_STR[k]) k++;
+            if (k > SYNTHETIC_PARTICLE || fields.size() > 3) {
+                printf("Error, unknown synthetic field %s, use synthetic:<grf|cloud|smooth|particle>[:<seed>[:<slope>]]\n",
+                       spec.c_str());
+                exit(0);
+            }
+            kind = (SYNTHETIC) k;
+            if (fields.size() > 1) seed = strtoull(fields[1].c_str(), nullptr, 10);
+            if (fields.size() > 2) slope = atof(fields[2].c_str());
+        }
+        synthetic_field(data, dims, kind, seed, slope);
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef SZ3_TILE_HPP
+#define SZ3_TILE_HPP
+
+/**
+ * Partition of a field into tiles for parallel compression.
+ * Tiles are cut along the slowest dimensions first, so that they stay slabs when dims[0] alone gives enough of them,
+ * and their cost is estimated from a sample so that the expensive tiles can be scheduled first.
+ */
+
+#include "SZ3/def.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace SZ {
+
+    struct Tile {
+        std::vector<size_t> start;  // first index along every dimension
+        std::vector<size_t> dims;
+        double cost = 0;
+    };
+
+    /**
+     * Cut the field into about target tiles of at least min_elements elements
+     * Dimensions are split from the slowest one, and no tile is thinner than min_extent along a split dimension.
+     */
+    inline std::vector<Tile> make_tiles(const std::vector<size_t> &dims, size_t target, size_t min_elements,
+                                        size_t min_extent = 8) {
+        size_t num = 1;
+        for (auto d: dims) {
+            num *= d;
+        }
+        target = std::max<size_t>(1, std::min(target, num / std::max<size_t>(1, min_elements)));
+        std::vector<size_t> parts(dims.size(), 1);
+        size_t tiles = 1;
+        for (size_t d = 0; d < dims.size() && tiles < target; d++) {
+            size_t need = (target + tiles - 1) / tiles;
+            parts[d] = std::max<size_t>(1, std::min(need, dims[d] / min_extent));
+            tiles *= parts[d];
+        }
+
+        std::vector<Tile> result(tiles);
+        std::vector<size_t> idx(dims.size(), 0);
+        for (auto &t: result) {
+            t.start.resize(dims.size());
+            t.dims.resize(dims.size());
+            for (size_t d = 0; d < dims.size(); d++) {
+                t.start[d] = idx[d] * dims[d] / parts[d];
+                t.dims[d] = (idx[d] + 1) * dims[d] / parts[d] - t.start[d];
+            }
+            for (size_t d = dims.size(); d-- > 0;) {
+                if (++idx[d] < parts[d]) break;
+                idx[d] = 0;
+            }
+        }
+        return result;
+    }
+
+    // whether the tile is a slab along dims[0], i.e. contiguous in the field
+    inline bool tile_is_slab(const std::vector<size_t> &dims, const Tile &tile) {
+        for (size_t d = 1; d < dims.size(); d++) {
+            if (tile.start[d] != 0 || tile.dims[d] != dims[d]) return false;
+        }
+        return true;
+    }
+
+    // call func(offset in the field, offset in the tile) for every row of the tile along the last dimension
+    template<class Func>
+    inline void tile_for_each_row(const std::vector<size_t> &dims, const Tile &tile, Func &&func) {
+        size_t n = dims.size();
+        std::vector<size_t> strides(n, 1);
+        for (size_t d = n - 1; d-- > 0;) {
+            strides[d] = strides[d + 1] * dims[d + 1];
+        }
+        size_t rows = 1;
+        for (size_t d = 0; d + 1 < n; d++) {
+            rows *= tile.dims[d];
+        }
+        std::vector<size_t> idx(n, 0);
+        for (size_t r = 0; r < rows; r++) {
+            size_t offset = 0;
+            for (size_t d = 0; d < n; d++) {
+                offset += (tile.start[d] + idx[d]) * strides[d];
+            }
+            func(offset, r * tile.dims[n - 1]);
+            for (size_t d = n - 1; d-- > 0;) {
+                if (++idx[d] < tile.dims[d]) break;
+                idx[d] = 0;
+            }
+        }
+    }
+
+    // copy the tile of the field into a contiguous buffer
+    template<class T>
+    void tile_gather(const T *field, const std::vector<size_t> &dims, const Tile &tile, T *buffer) {
+        size_t len = tile.dims.back();
+        tile_for_each_row(dims, tile, [&](size_t f, size_t t) { memcpy(buffer + t, field + f, len * sizeof(T)); });
+    }
+
+    // copy a contiguous buffer into the tile of the field
+    template<class T>
+    void tile_scatter(const T *buffer, const std::vector<size_t> &dims, const Tile &tile, T *field) {
+        size_t len = tile.dims.back();
+        tile_for_each_row(dims, tile, [&](size_t f, size_t t) { memcpy(field + f, buffer + t, len * sizeof(T)); });
+    }
+
+    /**
+     * Estimated compression cost of the tile, proportional to its size
+     * Zeros and points within eb of their left neighbor quantize to a few frequent symbols and are cheaper to encode,
+     * so the cost grows with the nonzero density and the gradient energy of up to about 64x64 sampled points.
+     */
+    template<class T>
+    double tile_cost(const T *field, const std::vector<size_t> &dims, const Tile &tile, double eb) {
+        size_t len = tile.dims.back(), elements = 1;
+        for (auto d: tile.dims) {
+            elements *= d;
+        }
+        size_t rows = elements / len;
+        size_t row_step = std::max<size_t>(1, rows / 64), col_step = std::max<size_t>(1, len / 64);
+        size_t sampled = 0, nonzero = 0, active = 0, r = 0;
+        tile_for_each_row(dims, tile, [&](size_t f, size_t) {
+            if (r++ % row_step) return;
+            const T *row = field + f;
+            for (size_t j = 1; j < len; j += col_step) {
+                sampled++;
+                nonzero += row[j] != 0;
+                active += std::fabs((double) row[j] - (double) row[j - 1]) > eb;
+            }
+        });
+        if (sampled == 0) {
+            return elements;
+        }
+        return elements * (0.2 + 0.4 * nonzero / sampled + 0.4 * active / sampled);
+    }
+}
+
+#endif
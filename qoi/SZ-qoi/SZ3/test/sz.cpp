@@ -2,6 +2,7 @@
 #include <cstdlib>
 #include <cmath>
 #include "SZ3/api/sz.hpp"
+#include "SZ3/utils/Synthetic.hpp"
 
 
 #define SZ_FLOAT 0
@@ -26,7 +27,12 @@ void usage() {
     printf("	-v: print the version number\n");
     printf("	-a : print compression results such as distortions\n");
     printf("* input and output:\n");
-    printf("	-i <path> : original binary input file\n");
+    printf("	-i <path> [<path> ...] : original binary input file(s), all following arguments up to the next option\n");
+    printf("	                        are input files; several files need -z without a path and no -o, they are\n");
+    printf("	                        compressed one by one to <path>.sz while the next file is read in the background\n");
+    printf("	-i synthetic:<kind>[:<seed>[:<slope>]] : generate the original data instead of reading a file, kind is\n");
+    printf("	                        grf (Gaussian random field), cloud (sparse), smooth or particle\n");
+    printf("	-D : read the original input with direct I/O (O_DIRECT), bypassing the page cache\n");
     printf("	-o <path> : compressed output file, default in binary format\n");
     printf("	-z <path> : compressed output (w -i) or input (w/o -i) file\n");
     printf("	-t : store compressed output file in text format\n");
@@ -46,6 +52,7 @@ void usage() {
     printf("		NORM (norm2 error : sqrt(sum(xi-xi')^2)\n");
     printf("		ABS_AND_REL (using min{ABS, REL})\n");
     printf("		ABS_OR_REL (using max{ABS, REL})\n");
+    printf("		RATIO (target compression ratio, the error bound is searched on a sample)\n");
     printf("	error bound can be set directly after the error control mode, or separately with the following options:\n");
     printf("		-A <absolute error bound>: specifying absolute error bound\n");
     printf("		-R <value_range based relative error bound>: specifying relative error bound\n");
@@ -63,6 +70,8 @@ void usage() {
     printf("	sz -f -i test.dat    -o test.dat.sz.out -3 8 8 128 -M ABS_AND_REL -A 1 -R 1e-3 -a \n");
     printf("	sz -f -i test.dat    -o test.dat.sz.out -3 8 8 128 -c sz.config \n");
     printf("	sz -f -i test.dat    -o test.dat.sz.out -3 8 8 128 -c sz.config -M ABS 1e-3 -a\n");
+    printf("	sz -f -z -i test1.dat test2.dat test3.dat -3 8 8 128 -M ABS 1e-3 \n");
+    printf("	sz -f -i synthetic:grf:1 -o grf.sz.out -3 256 256 256 -M REL 1e-3 -a\n");
     exit(0);
 }
 
@@ -122,15 +131,17 @@ void usage_sz2() {
     exit(0);
 }
 
-template<class T>
-void compress(char *inPath, char *cmpPath, SZ::Config conf) {
-    T *data = new T[conf.num];
-    SZ::readfile<T>(inPath, conf.num, data);
-
+// data is either a buffer the compressor may overwrite (T *) or a read-only input (const T *)
+template<class T, class Data>
+void compress(Data *data, char *inPath, char *cmpPath, SZ::Config conf) {
     size_t outSize;
+    SZ::Profile profile;
     SZ::Timer timer(true);
-    char *bytes = SZ_compress<T>(conf, data, outSize);
+    char *bytes = SZ_compress<T>(conf, data, outSize, profile);
     double compress_time = timer.stop();
+#if SZ3_DEBUG_TIMINGS
+    profile.print();
+#endif
 
     char outputFilePath[1024];
     if (cmpPath == nullptr) {
@@ -144,21 +155,61 @@ void compress(char *inPath, char *cmpPath, SZ::Config conf) {
     printf("compression time = %f\n", compress_time);
     printf("compressed data file = %s\n", outputFilePath);
 
-    delete[]data;
     delete[]bytes;
 }
 
+template<class T>
+void compress(char *inPath, char *cmpPath, SZ::Config conf, bool directIO) {
+    if (SZ::synthetic_check(inPath)) {
+        std::vector<T> data(conf.num);
+        SZ::synthetic_load(inPath, data.data(), conf.dims);
+        compress<T>(data.data(), inPath, cmpPath, conf);
+    } else if (directIO) {
+        auto data = SZ::aligned_buffer<T>(conf.num);
+        SZ::readfile_direct<T>(inPath, conf.num, data.get());
+        compress<T>(data.get(), inPath, cmpPath, conf);
+    } else {
+        // read-only map compressed without modifying it, the pages stay shared with the page cache
+        SZ::MappedFile<T> data(inPath);
+        if (data.size() != conf.num) {
+            printf("Error, file size of %s is not equal to the input setting\n", inPath);
+            exit(0);
+        }
+        compress<T>((const T *) data.data(), inPath, cmpPath, conf);
+    }
+}
+
+// compress several files of the same shape, reading the next file while the current one is compressed
+template<class T>
+void compress_batch(const std::vector<char *> &inPaths, SZ::Config conf, bool directIO) {
+    SZ::FilePrefetcher<T> prefetcher;
+    prefetcher.prefetch(inPaths[0], conf.num, directIO);
+    for (size_t i = 0; i < inPaths.size(); i++) {
+        auto data = prefetcher.get();
+        if (i + 1 < inPaths.size()) {
+            prefetcher.prefetch(inPaths[i + 1], conf.num, directIO);
+        }
+        printf("input data file = %s\n", inPaths[i]);
+        compress<T>(data.get(), inPaths[i], nullptr, conf);
+    }
+}
+
 template<class T>
 void decompress(char *inPath, char *cmpPath, char *decPath,
                 SZ::Config conf,
                 int binaryOutput, int printCmpResults) {
 
-    size_t cmpSize;
-    auto cmpData = SZ::readfile<char>(cmpPath, cmpSize);
+    SZ::MappedFile<char> cmpData(cmpPath, true);
+    size_t cmpSize = cmpData.size();
 
+    SZ::Profile profile;
+    T *decData = nullptr;
     SZ::Timer timer(true);
-    T *decData = SZ_decompress<T>(conf, cmpData.get(), cmpSize);
+    SZ_decompress<T>(conf, cmpData.data(), cmpSize, decData, profile);
     double compress_time = timer.stop();
+#if SZ3_DEBUG_TIMINGS
+    profile.print();
+#endif
 
     char outputFilePath[1024];
     if (decPath == nullptr) {
@@ -173,21 +224,31 @@ void decompress(char *inPath, char *cmpPath, char *decPath,
     }
     if (printCmpResults) {
         //compute the distortion / compression errors...
-        size_t totalNbEle;
-        auto ori_data = SZ::readfile<T>(inPath, totalNbEle);
-        assert(totalNbEle == conf.num);
+        std::unique_ptr<SZ::MappedFile<T>> ori_file;
+        std::vector<T> ori_synthetic;
+        T *ori_data;
+        if (SZ::synthetic_check(inPath)) {
+            ori_synthetic.resize(conf.num);
+            SZ::synthetic_load(inPath, ori_synthetic.data(), conf.dims);
+            ori_data = ori_synthetic.data();
+        } else {
+            // read-only map, the original data are only compared against
+            ori_file = std::make_unique<SZ::MappedFile<T>>(inPath);
+            assert(ori_file->size() == conf.num);
+            ori_data = ori_file->data();
+        }
         std::vector<T> isovalues(conf.isovalues.size());
         for(int i=0; i<conf.isovalues.size(); i++){
             isovalues[i] = conf.isovalues[i];
         }
         if(conf.dims.size() == 2){
-            SZ::evaluate_isoline(ori_data.get(), decData, conf.dims, isovalues);
+            SZ::evaluate_isoline(ori_data, decData, conf.dims, isovalues);
         }
         else if(conf.dims.size() == 3){
-            SZ::evaluate_isosurface(ori_data.get(), decData, conf.dims, isovalues);
+            SZ::evaluate_isosurface(ori_data, decData, conf.dims, isovalues);
         }
         // SZ::verify<T>(ori_data.get(), decData, conf.num);
-        SZ::verifyQoI<T>(ori_data.get(), decData, conf.dims, conf.qoiRegionSize);
+        SZ::verifyQoI<T>(ori_data, decData, conf.dims, conf.qoiRegionSize);
     }
     delete[]decData;
 
@@ -203,6 +264,8 @@ int main(int argc, char *argv[]) {
     bool decompression = false;
     int dataType = SZ_FLOAT;
     char *inPath = nullptr;
+    std::vector<char *> inPaths;
+    bool directIO = false;
     char *cmpPath = nullptr;
     char *conPath = nullptr;
     char *decPath = nullptr;
@@ -296,6 +359,13 @@ int main(int argc, char *argv[]) {
                 if (++i == argc)
                     usage();
                 inPath = argv[i];
+                inPaths.push_back(argv[i]);
+                while (i + 1 < argc && argv[i + 1][0] != '-') {
+                    inPaths.push_back(argv[++i]);
+                }
+                break;
+            case 'D':
+                directIO = true;
                 break;
             case 'o':
                 if (++i == argc)
@@ -456,6 +526,11 @@ int main(int argc, char *argv[]) {
             conf.errorBoundMode = SZ::EB_ABS_AND_REL;
         } else if (strcmp(errBoundMode, SZ::EB_STR[SZ::EB_ABS_OR_REL]) == 0) {
             conf.errorBoundMode = SZ::EB_ABS_OR_REL;
+        } else if (strcmp(errBoundMode, SZ::EB_STR[SZ::EB_RATIO]) == 0) {
+            conf.errorBoundMode = SZ::EB_RATIO;
+            if (errBound != nullptr) {
+                conf.targetRatio = atof(errBound);
+            }
         } else {
             printf("Error: wrong error bound mode setting by using the option '-M'\n");
             usage();
@@ -463,16 +538,37 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (inPaths.size() > 1) {
+        if (cmpPath != nullptr || decompression) {
+            printf("Error: several input files are only supported in compression with -z but no path and without -o\n");
+            exit(0);
+        }
+        if (dataType == SZ_FLOAT) {
+            compress_batch<float>(inPaths, conf, directIO);
+        } else if (dataType == SZ_DOUBLE) {
+            compress_batch<double>(inPaths, conf, directIO);
+        } else if (dataType == SZ_INT32) {
+            compress_batch<int32_t>(inPaths, conf, directIO);
+        } else if (dataType == SZ_INT64) {
+            compress_batch<int64_t>(inPaths, conf, directIO);
+        } else {
+            printf("Error: data type not supported \n");
+            usage();
+            exit(0);
+        }
+        return 0;
+    }
+
     if (compression) {
 
         if (dataType == SZ_FLOAT) {
-            compress<float>(inPath, cmpPath, conf);
+            compress<float>(inPath, cmpPath, conf, directIO);
         } else if (dataType == SZ_DOUBLE) {
-            compress<double>(inPath, cmpPath, conf);
+            compress<double>(inPath, cmpPath, conf, directIO);
         } else if (dataType == SZ_INT32) {
-            compress<int32_t>(inPath, cmpPath, conf);
+            compress<int32_t>(inPath, cmpPath, conf, directIO);
         } else if (dataType == SZ_INT64) {
-            compress<int64_t>(inPath, cmpPath, conf);
+            compress<int64_t>(inPath, cmpPath, conf, directIO);
         } else {
             printf("Error: data type not supported \n");
             usage();
@@ -0,0 +1,63 @@
+#include "SZ3/compressor/SZTruncateCompressor.hpp"
+#include "SZ3/lossless/Lossless_zstd.hpp"
+#include "SZ3/utils/Config.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+// round trip of SZTruncateCompressor: the top byteLen bytes of every value are kept, the others are zero
+template<class T>
+bool test(size_t n, int byteLen, bool shuffle) {
+    typedef typename std::conditional<sizeof(T) == 8, uint64_t, uint32_t>::type U;
+    std::vector<T> data(n);
+    for (size_t i = 0; i < n; i++) {
+        data[i] = (T) (std::sin(i * 0.01) * 1000 + i * 1e-3);
+    }
+    std::vector<T> expected(n);
+    for (size_t i = 0; i < n; i++) {
+        U word;
+        memcpy(&word, &data[i], sizeof(T));
+        if (byteLen < (int) sizeof(T)) {
+            word &= ~(((U) 1 << (8 * (sizeof(T) - byteLen))) - 1);
+        }
+        memcpy(&expected[i], &word, sizeof(T));
+    }
+
+    SZ::Config conf(n);
+    auto sz = SZ::make_sz_truncate_compressor<T, 1>(conf, SZ::Lossless_zstd(), byteLen, shuffle);
+    size_t cmpSize = 0;
+    SZ::uchar *cmpData = sz.compress(conf, data.data(), cmpSize);
+
+    // the layout is read from the stream, not from the shuffle argument of the decompressor
+    auto dec_sz = SZ::make_sz_truncate_compressor<T, 1>(conf, SZ::Lossless_zstd(), byteLen, !shuffle);
+    std::vector<T> dec(n);
+    dec_sz.decompress(cmpData, cmpSize, dec.data());
+    delete[] cmpData;
+
+    if (memcmp(dec.data(), expected.data(), n * sizeof(T)) != 0) {
+        std::cout << "Error, " << (sizeof(T) == 4 ? "float" : "double") << " n = " << n << " byteLen = " << byteLen
+                  << " shuffle = " << shuffle << " is not recovered" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    const size_t lengths[] = {1, 7, SZ::SHUFFLE_BLOCK - 1, SZ::SHUFFLE_BLOCK, SZ::SHUFFLE_BLOCK + 1,
+                              3 * SZ::SHUFFLE_BLOCK + 123};
+    bool ok = true;
+    for (size_t n: lengths) {
+        for (int byteLen = 1; byteLen <= 4; byteLen++) {
+            ok &= test<float>(n, byteLen, true);
+            ok &= test<float>(n, byteLen, false);
+        }
+        for (int byteLen = 1; byteLen <= 8; byteLen++) {
+            ok &= test<double>(n, byteLen, true);
+        }
+    }
+    std::cout << (ok ? "All truncate tests passed" : "Some truncate tests failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -11,6 +11,8 @@
 
 #include "mgard/compress_x.hpp"
 #include "mgard/mgard-x/Utilities/ErrorCalculator.h"
+#include "SZ3/utils/Synthetic.hpp"
+#include "SZ3/utils/Metrics.hpp"
 
 //#define MYADIOS_USE_MPI 1
 #if MYADIOS_USE_MPI
@@ -25,7 +27,7 @@ void print_usage_message(std::string error) {
   }
   printf("Options\n\
 \t -z: compress data\n\
-\t\t -i <path to data file to be compressed>\n\
+\t\t -i <path to data file to be compressed, or synthetic:<grf|cloud|smooth|particle>[:<seed>[:<slope>]]>\n\
 \t\t -c <path to compressed file>\n\
 \t\t -t <s|d>: data type (s: single; d:double)\n\
 \t\t -n <ndim>: total number of dimensions\n\
@@ -216,15 +218,17 @@ void writefile(const char *output_file, size_t num_bytes, T *out_buff) {
 // template <typename T>
 void print_statistics(double s, enum mgard_x::error_bound_type mode,
                       std::vector<mgard_x::SIZE> shape, float *original_data,
-                      float *decompressed_data, float tol, bool normalize_coordinates) {
+                      float *decompressed_data, float tol, bool normalize_coordinates,
+                      const SZ::ErrorMetrics &error_metrics) {
   mgard_x::SIZE n = 1;
   for (mgard_x::DIM d = 0; d < shape.size(); d++)
     n *= shape[d];
   float actual_error = 0.0;
   std::cout << std::scientific;
   if (s == std::numeric_limits<float>::infinity()) {
-    actual_error =
-        mgard_x::L_inf_error(n, original_data, decompressed_data, mode);
+    actual_error = mode == mgard_x::error_bound_type::REL
+                       ? error_metrics.max_abs_error / error_metrics.max_abs_value
+                       : error_metrics.max_abs_error;
     if (mode == mgard_x::error_bound_type::ABS) {
       std::cout << mgard_x::log::log_info
                 << "Absoluate L_inf error: " << actual_error << " ("
@@ -261,11 +265,11 @@ void print_statistics(double s, enum mgard_x::error_bound_type mode,
   }
 
   std::cout << mgard_x::log::log_info
-            << "MSE: " << mgard_x::MSE(n, original_data, decompressed_data)
+            << "MSE: " << error_metrics.mse
             << "\n";
   std::cout << std::defaultfloat;
   std::cout << mgard_x::log::log_info
-            << "PSNR: " << mgard_x::PSNR(n, original_data, decompressed_data)
+            << "PSNR: " << error_metrics.psnr
             << "\n";
 
   // if (actual_error > tol)
@@ -296,47 +300,15 @@ struct Metrics {
     float linearmaxError;
 };
 
-Metrics calculateMetrics(const float* original, const float* decompressed, size_t size, int k) {
-    float relaError = 0.0;
-    float rmseSum = 0.0;
-    float maxError = 0.0;
-    double avgOriginal = 0.0;
-    double avgDecompressed = 0.0;
-    float linearmaxError = 0.0;
-
-    // Calculate dataRange
-    float minOriginal = original[0];
-    float maxOriginal = original[0];
-
-    for (size_t i = 0; i < size; ++i) {
-      minOriginal = std::min(minOriginal, original[i]);
-      maxOriginal = std::max(maxOriginal, original[i]);
-    }
-
-    float dataRange = maxOriginal - minOriginal;
-
-    for (size_t i = 0; i < size; ++i) {
-        // relaError = std::max(std::abs(decompressed[i] - original[i]));
-
-
-        float squaredError = std::pow(original[i] - decompressed[i], 2);
-        rmseSum += squaredError;
-
-        maxError = std::max(maxError, std::abs(original[i] - decompressed[i]));
-
-        avgOriginal += original[i];
-        avgDecompressed += decompressed[i];
-    }
-
-    float avgDistance = std::abs(avgOriginal / size - avgDecompressed / size);
-    std::cout << "Max error " << maxError << " range " << dataRange << std::endl;
+Metrics calculateMetrics(const SZ::ErrorMetrics &m, int k) {
+    std::cout << "Max error " << (float) m.max_abs_error << " range " << (float) m.range << std::endl;
 
     Metrics metrics;
-    metrics.relativeErrors = maxError/ dataRange;
-    metrics.rmse = std::sqrt(rmseSum / size);
-    metrics.maxError = maxError;
-    metrics.avgDistance = avgDistance;
-    metrics.linearmaxError = maxError * k;
+    metrics.relativeErrors = m.max_rel_error;
+    metrics.rmse = m.rmse;
+    metrics.maxError = m.max_abs_error;
+    metrics.avgDistance = m.mean_shift;
+    metrics.linearmaxError = m.max_abs_error * k;
 
     return metrics;
 }
@@ -408,12 +380,9 @@ result launch_compress(mgard_x::DIM D, enum mgard_x::data_type dtype,
  
   float* original_data = new float[original_size];
 
-  if (std::string(input_file).compare("random") == 0) {
-    srand(7117);
-    T c = 0;
-    for (size_t i = 0; i < original_size*accumulate_data; i++) {
-      original_data[i] = rand() % 10 + 1;
-    }
+  if (SZ::synthetic_check(input_file)) {
+    std::vector<size_t> dims(shape.begin(), shape.end());
+    SZ::synthetic_load(input_file, original_data, dims);
   } else {
     readfile(input_file, original_data, original_size * sizeof(float));
   }
@@ -522,7 +491,9 @@ result launch_compress(mgard_x::DIM D, enum mgard_x::data_type dtype,
   //  for (int i = 0; i < original_size; i++)
   //  std::cout << " " << original_data[i] << " ";
 
-  Metrics metrics = calculateMetrics(original_data, (float*)decompressed_data, original_size, k_parameter);
+  // all error metrics come from one parallel pass with double accumulators
+  SZ::ErrorMetrics error_metrics = SZ::compute_error_metrics(original_data, (float*)decompressed_data, original_size);
+  Metrics metrics = calculateMetrics(error_metrics, k_parameter);
   std::cout << "Relative : " << metrics.relativeErrors << "\n";
   std::cout << "RMSE: " << metrics.rmse << "\n";
   std::cout << "Max Error: " << metrics.maxError << "\n";
@@ -533,7 +504,7 @@ result launch_compress(mgard_x::DIM D, enum mgard_x::data_type dtype,
   else
     std::cout << "********** Fail with error preservation **********\n";
   print_statistics(s, mode, shape, original_data, (float *)decompressed_data,
-                      tol, config.normalize_coordinates);
+                      tol, config.normalize_coordinates, error_metrics);
   
   delete[](double *) original_data;
   delete[](unsigned char *) compressed_data;
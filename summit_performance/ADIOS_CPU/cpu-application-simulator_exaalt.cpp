@@ -10,6 +10,7 @@
 
 #include "mgard/compress_x.hpp"
 #include "mgard/mgard-x/Utilities/ErrorCalculator.h"
+#include "SZ3/utils/Synthetic.hpp"
 
 #define MYADIOS_USE_MPI 1
 #include <adios2.h>
@@ -25,7 +26,7 @@ void print_usage_message(std::string error) {
   }
   printf("Options\n\
 \t -z: compress data\n\
-\t\t -i <path to data file to be compressed>\n\
+\t\t -i <path to data file to be compressed, or synthetic:<grf|cloud|smooth|particle>[:<seed>[:<slope>]]>\n\
 \t\t -c <path to compressed file>\n\
 \t\t -t <s|d>: data type (s: single; d:double)\n\
 \t\t -n <ndim>: total number of dimensions\n\
@@ -364,12 +365,9 @@ result launch_compress(mgard_x::DIM D, enum mgard_x::data_type dtype,
  
   double* original_data = new double[original_size];
 
-  if (std::string(input_file).compare("random") == 0) {
-    srand(7117);
-    T c = 0;
-    for (size_t i = 0; i < original_size*accumulate_data; i++) {
-      original_data[i] = rand() % 10 + 1;
-    }
+  if (SZ::synthetic_check(input_file)) {
+    std::vector<size_t> dims(shape.begin(), shape.end());
+    SZ::synthetic_load(input_file, original_data, dims);
   } else {
     readfile(input_file, original_data, original_size * sizeof(double));
   }